@@ -37,7 +37,8 @@ enum cmd_status {
 struct cmd_results {
     enum cmd_status status;
     /**
-     * Human friendly error message, or NULL on success
+     * Human friendly error message, or NULL on success.  Commands that produce
+     * output, such as `latency dump`, return it here alongside CMD_SUCCESS.
      */
     char *error;
 };
@@ -114,9 +115,11 @@ hwd_cmd cmd_font;
 hwd_cmd cmd_force_display_urgency_hint;
 hwd_cmd cmd_fullscreen;
 hwd_cmd cmd_haywardnag_command;
+hwd_cmd cmd_hidden_frame_rate;
 hwd_cmd cmd_include;
 hwd_cmd cmd_input;
 hwd_cmd cmd_kill;
+hwd_cmd cmd_latency;
 hwd_cmd cmd_layout;
 hwd_cmd cmd_mode;
 hwd_cmd cmd_move;
@@ -101,6 +101,10 @@ struct hwd_mode {
     list_t *mouse_bindings;
     list_t *switch_bindings;
     bool pango;
+
+    // Index over `mouse_bindings`.  Built on first use, and discarded whenever
+    // `mouse_bindings` is modified.
+    struct hwd_binding_index *mouse_binding_index;
 };
 
 struct input_config_mapped_from_region {
@@ -254,6 +258,9 @@ struct hwd_config {
     char *haywardnag_command;
     struct haywardnag_instance haywardnag_config_errors;
     list_t *symbols;
+    // Hash index over `symbols`, built on first use.  Variables must be added
+    // with `config_add_variable` so that it is kept up to date.
+    struct hwd_variable_index *symbol_index;
     list_t *modes;
     list_t *cmd_queue;
     list_t *output_configs;
@@ -285,6 +292,10 @@ struct hwd_config {
 
     int tiling_drag_threshold;
 
+    // Rate, in Hz, at which hidden or fully covered windows are sent frame
+    // callbacks.
+    int hidden_frame_rate;
+
     list_t *config_chain;
     bool user_config_path;
     const char *current_config_path;
@@ -359,6 +370,19 @@ free_config(struct hwd_config *config);
 void
 free_hwd_variable(struct hwd_variable *var);
 
+/**
+ * Returns the variable with the given name, including the leading `$`, or NULL
+ * if it has not been set.
+ */
+struct hwd_variable *
+config_get_variable(struct hwd_config *config, const char *name);
+
+/**
+ * Adds a variable that has not been set before.
+ */
+void
+config_add_variable(struct hwd_config *config, struct hwd_variable *var);
+
 /**
  * Does variable replacement for a string based on the config's currently loaded
  * variables.
@@ -431,6 +455,29 @@ translate_keysyms(struct input_config *input_config);
 void
 binding_add_translated(struct hwd_binding *binding, list_t *bindings);
 
+/**
+ * Creates a hash index over a list of bindings, keyed by modifiers, keys, and
+ * whether the binding triggers on release.  The index holds references to the
+ * bindings in the list, and must be recreated if the list changes.
+ */
+struct hwd_binding_index *
+binding_index_create(list_t *bindings);
+
+void
+binding_index_destroy(struct hwd_binding_index *index);
+
+/**
+ * Returns the next binding with exactly the given modifiers, release flag and
+ * sorted keys, or NULL once there are no more.  `iter` should point to zero
+ * before the first call.  Bindings are returned in the order they appear in
+ * the list that the index was created from.
+ */
+struct hwd_binding *
+binding_index_next(
+    struct hwd_binding_index *index, uint32_t modifiers, bool release, const uint32_t *keys,
+    size_t num_keys, size_t *iter
+);
+
 /* Global config singleton. */
 extern struct hwd_config *config;
 
@@ -11,9 +11,22 @@ struct hwd_workspace_handle_v1 {
     struct wl_list resources; // wl_resource_get_link()
     struct wl_list link;
 
+    // State as last sent to clients.
     char *name;
     bool focused;
 
+    // Set once the workspace has been announced to clients.  Until then it is
+    // invisible to them, and destroying it sends nothing.
+    bool announced;
+
+    // State to be sent to clients by the next call to
+    // `hwd_workspace_manager_v1_flush`.
+    struct {
+        char *name;
+        bool focused;
+    } pending;
+    struct wl_list dirty_link; // hwd_workspace_manager_v1::dirty_workspaces
+
     struct {
         // struct hwd_workspace_handle_v1_focus_event
         struct wl_signal request_focus;
@@ -39,13 +52,14 @@ void
 hwd_workspace_handle_v1_set_focused(struct hwd_workspace_handle_v1 *workspace, bool focused);
 
 struct hwd_workspace_manager_v1 {
-    struct wl_event_loop *event_loop;
     struct wl_global *global;
 
-    struct wl_list resources;  // wl_resource_get_link()
-    struct wl_list workspaces; // hwd_workspace_handle_v1::link
+    struct wl_list resources;        // wl_resource_get_link()
+    struct wl_list workspaces;       // hwd_workspace_handle_v1::link
+    struct wl_list dirty_workspaces; // hwd_workspace_handle_v1::dirty_link
 
-    struct wl_event_source *idle_source;
+    // Set if a workspace has been closed since the last flush.
+    bool dirty;
 
     struct {
         struct wl_signal destroy;
@@ -55,4 +69,13 @@ struct hwd_workspace_manager_v1 {
 struct hwd_workspace_manager_v1 *
 hwd_workspace_manager_v1_create(struct wl_display *display);
 
+/**
+ * Sends everything that has changed since the last flush, followed by a
+ * single `done` event, to every client.  Properties that have been set back to
+ * the value last sent are skipped, and nothing at all is sent if nothing has
+ * changed.  Workspace handles only accumulate changes until this is called.
+ */
+void
+hwd_workspace_manager_v1_flush(struct hwd_workspace_manager_v1 *manager);
+
 #endif
@@ -23,6 +23,10 @@ struct hwd_layer_surface {
     bool mapped;
     struct hwd_output *output;
 
+    // State as of the last commit that caused the output to be rearranged.
+    // Only the fields that affect placement are compared.
+    struct wlr_layer_surface_v1_state arranged;
+
     struct wlr_scene_layer_surface_v1 *scene;
     struct wlr_scene_tree *scene_tree;
     struct wlr_addon scene_tree_marker;
@@ -17,6 +17,11 @@
 struct hwd_xdg_shell {
     struct wlr_xdg_shell *xdg_shell;
 
+    // Hidden or covered views waiting for a throttled frame callback.  Flushed
+    // together by `hidden_frame_timer`.
+    struct wl_list hidden_frame_views; // hwd_xdg_shell_view::hidden_frame_link
+    struct wl_event_source *hidden_frame_timer;
+
     struct wl_listener new_toplevel;
 };
 
@@ -38,6 +43,7 @@ struct hwd_xdg_shell_view {
     bool configured_is_resizing;
     bool configured_is_tiled;
     bool configured_is_fullscreen;
+    bool configured_is_suspended;
     int configured_width;
     int configured_height;
 
@@ -52,6 +58,13 @@ struct hwd_xdg_shell_view {
 
     struct wlr_scene_tree *scene_tree;
 
+    // Fires once the toplevel has been hidden for long enough that it should
+    // be suspended.  `suspend_pending` is set while the timer is armed.
+    struct wl_event_source *suspend_timer;
+    bool suspend_pending;
+
+    struct wl_list hidden_frame_link; // Empty if no hidden frame is pending.
+
     struct wl_listener wlr_xdg_toplevel_request_move;
     struct wl_listener wlr_xdg_toplevel_request_resize;
     struct wl_listener wlr_xdg_toplevel_request_fullscreen;
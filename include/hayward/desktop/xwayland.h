@@ -40,8 +40,15 @@ struct hwd_xwayland {
 
     xcb_atom_t atoms[ATOM_LAST];
 
+    // Views that have been moved, but not resized, by the current
+    // transaction.  These are sent configures together when the transaction
+    // is applied, without making the transaction wait for them.
+    // `transaction_apply` is only attached while the list is non-empty.
+    struct wl_list pending_moves; // hwd_xwayland_view::pending_move_link
+
     struct wl_listener new_surface;
     struct wl_listener ready;
+    struct wl_listener transaction_apply;
 };
 
 struct hwd_xwayland_view {
@@ -62,6 +69,8 @@ struct hwd_xwayland_view {
     int configured_width;
     int configured_height;
 
+    struct wl_list pending_move_link; // Empty if no move is pending.
+
     // The geometry for whatever the client is committing, regardless of
     // transaction state. Updated on every commit.
     struct wlr_box geometry;
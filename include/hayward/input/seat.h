@@ -13,6 +13,7 @@
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_input_device.h>
 #include <wlr/types/wlr_keyboard_shortcuts_inhibit_v1.h>
+#include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_pointer.h>
 #include <wlr/types/wlr_seat.h>
 #include <wlr/types/wlr_tablet_tool.h>
@@ -44,6 +45,15 @@ struct hwd_seatop_impl {
     void (*unref)(struct hwd_seat *seat, struct hwd_window *window);
     void (*render)(struct hwd_seat *seat, struct hwd_output *output, pixman_region32_t *damage);
     bool allow_set_cursor;
+
+    // If set, pointer motion is coalesced so that the seatop handles at most
+    // one motion event per frame of the output under the cursor.
+    bool throttle_motion;
+
+    // If set, pointer motion is additionally held back until the transaction
+    // triggered by the previous motion event has been applied, so that clients
+    // are never sent a configure before they have acked the last one.
+    bool throttle_motion_configure;
 };
 
 struct hwd_seat_device {
@@ -80,6 +90,24 @@ struct hwd_seat {
     const struct hwd_seatop_impl *seatop_impl;
     void *seatop_data;
 
+    // Latest pointer motion not yet delivered to a throttled seatop.
+    struct {
+        bool pending;
+        uint32_t time_msec;
+
+        // Output whose next frame will deliver the pending motion.  NULL if no
+        // frame has been requested.
+        struct wlr_output *output;
+
+        // Set while waiting for the transaction triggered by the last delivered
+        // motion to be applied.
+        bool waiting_transaction;
+
+        struct wl_listener output_frame;
+        struct wl_listener output_destroy;
+        struct wl_listener transaction_after_apply;
+    } seatop_motion;
+
     uint32_t last_button_serial;
 
     uint32_t idle_inhibit_sources, idle_wake_sources;
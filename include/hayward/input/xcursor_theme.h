@@ -0,0 +1,33 @@
+#ifndef HWD_INPUT_XCURSOR_THEME_H
+#define HWD_INPUT_XCURSOR_THEME_H
+
+#include <config.h>
+
+#include <wlr/types/wlr_xcursor_manager.h>
+
+/**
+ * Process-wide cache of cursor themes.
+ *
+ * Seats and Xwayland that are configured with the same theme name and size
+ * share a single reference counted `wlr_xcursor_manager`.  Each manager loads
+ * a scale the first time a cursor is shown on an output with that scale, and
+ * keeps it for as long as the theme is in use.
+ */
+
+/**
+ * Returns a cursor theme manager for the named theme at the given size,
+ * creating it if it is not already in use.  `name` may be NULL to select the
+ * default theme.  Returns NULL if the theme could not be created.  Every
+ * manager returned must eventually be passed to `hwd_xcursor_theme_release`.
+ */
+struct wlr_xcursor_manager *
+hwd_xcursor_theme_acquire(const char *name, unsigned size);
+
+/**
+ * Drops a reference acquired with `hwd_xcursor_theme_acquire`, destroying the
+ * manager once it is no longer in use.  Accepts NULL.
+ */
+void
+hwd_xcursor_theme_release(struct wlr_xcursor_manager *manager);
+
+#endif
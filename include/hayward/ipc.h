@@ -0,0 +1,88 @@
+#ifndef HWD_IPC_H
+#define HWD_IPC_H
+
+#include <config.h>
+
+#include <stdint.h>
+
+#include <wayland-server-core.h>
+
+/**
+ * Unix socket for controlling the compositor at runtime.
+ *
+ * The socket is created in `$XDG_RUNTIME_DIR`, and its path exported to
+ * processes launched by the compositor as `HAYWARDSOCK`.
+ *
+ * Messages in both directions are a header, made up of the length of the
+ * payload and the message type, followed by the payload.  All integers are in
+ * native byte order, as the socket is only reachable from the local machine,
+ * and are unsigned except for geometry.  Geometry is encoded as x, y, width
+ * and height, each an int32 in layout coordinates.  Strings are encoded as a
+ * uint32 length followed by that many bytes, without a terminator.
+ *
+ * Events are batched: at most one event message is sent to each subscriber
+ * after each transaction is applied, or after focus changes outside of a
+ * transaction, however many changes the transaction included, and it only
+ * includes the sections that changed.  Events carry the new state, so clients
+ * never need to query after being notified.
+ */
+
+#define HWD_IPC_HEADER_SIZE 8
+#define HWD_IPC_MAX_PAYLOAD_SIZE (1 << 20)
+
+enum hwd_ipc_message_type {
+    // Request payload: command string.  Reply payload: number of commands
+    // executed as uint32, then for each its `enum cmd_status` as uint32 and
+    // error string.  On success the string holds the command's output, if
+    // any, and is otherwise empty.
+    HWD_IPC_RUN_COMMAND = 0,
+
+    // Request payload: mask of `enum hwd_ipc_event_type` as uint32.  Replaces
+    // any previous subscription.  Reply payload: the subscribed mask.  The
+    // reply is followed by an event carrying the current state for every
+    // subscribed type.
+    HWD_IPC_SUBSCRIBE = 2,
+
+    // Sent by the compositor only.  Payload: mask of the event types that
+    // changed as uint32, followed by a section for each of them in order of
+    // increasing bit.
+    HWD_IPC_EVENT = 0x80000000,
+};
+
+enum hwd_ipc_event_type {
+    // Number of outputs as uint32, then for each its id as uint64, its name and
+    // its geometry.  Then the number of workspaces as uint32, then for each its
+    // id as uint64, the number of columns as uint32 followed by the columns,
+    // and the number of floating windows as uint32 followed by the windows.  A
+    // column is its id as uint64, the id of its output as uint64, its geometry,
+    // and the number of windows as uint32 followed by the windows.  A window is
+    // its id as uint64, the id of its output as uint64, its geometry, and
+    // `HWD_IPC_WINDOW_*` flags as uint32.
+    HWD_IPC_EVENT_TREE = 1 << 0,
+
+    // Id of the focused window as uint64, or zero if no window is focused,
+    // followed by its title.
+    HWD_IPC_EVENT_FOCUS = 1 << 1,
+
+    // Number of workspaces as uint32, then for each its id as uint64, its
+    // name, and `HWD_IPC_WORKSPACE_*` flags as uint32.
+    HWD_IPC_EVENT_WORKSPACE = 1 << 2,
+};
+
+#define HWD_IPC_EVENT_ALL (HWD_IPC_EVENT_TREE | HWD_IPC_EVENT_FOCUS | HWD_IPC_EVENT_WORKSPACE)
+
+#define HWD_IPC_WORKSPACE_ACTIVE (1 << 0)
+#define HWD_IPC_WORKSPACE_URGENT (1 << 1)
+
+#define HWD_IPC_WINDOW_SHADED (1 << 0)
+#define HWD_IPC_WINDOW_FULLSCREEN (1 << 1)
+
+struct hwd_ipc;
+
+struct hwd_ipc *
+hwd_ipc_create(struct wl_event_loop *event_loop);
+
+void
+hwd_ipc_destroy(struct hwd_ipc *ipc);
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef HWD_LATENCY_H
+#define HWD_LATENCY_H
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <wayland-util.h>
+
+/**
+ * Input-to-photon latency tracking.
+ *
+ * Every input event handled by a seat is stamped with the time it was received
+ * and given a serial.  When an output next commits a frame with new damage it
+ * claims the oldest input event it has not yet seen that was received within
+ * the last couple of refresh periods, records the time from that event to the
+ * commit, and then the time from that event to the presentation of the frame
+ * once the backend reports it.  Frames with no recent input are not counted.
+ *
+ * Workspace switches are tracked separately, to measure the time from a switch
+ * being requested to the new workspace being presented.  A switch can only be
+ * claimed by frames committed after the transaction that shows the new
+ * workspace has been applied, so that the time spent waiting for clients to
+ * resize is included.
+ */
+
+#define HWD_LATENCY_HISTOGRAM_BUCKETS 24
+
+/**
+ * Log2 histogram of latencies in microseconds.  Bucket `n` counts samples in
+ * the range [2^n, 2^(n + 1)), with bucket 0 also holding samples of zero.
+ */
+struct hwd_latency_histogram {
+    uint64_t buckets[HWD_LATENCY_HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t total_usec;
+    uint64_t max_usec;
+};
+
+struct hwd_latency_output {
+    struct wl_list link; // hwd_latency_outputs
+
+    char *name;
+
+    // Duration of a frame, as last reported by the backend.
+    uint64_t refresh_nsec;
+
+    // Serial of the most recent input event this output has accounted for.
+    uint64_t input_serial;
+
+    // Receipt time of the input event attributed to the frame that is waiting
+    // to be presented.
+    bool frame_pending;
+    uint64_t frame_input_nsec;
+
+    struct hwd_latency_histogram event_to_commit;
+    struct hwd_latency_histogram event_to_present;
+
+    // As above, but for workspace switches.
+    uint64_t switch_serial;
+    bool switch_frame_pending;
+    uint64_t switch_frame_nsec;
+
+    struct hwd_latency_histogram switch_to_present;
+};
+
+void
+hwd_latency_notify_input(void);
+
+void
+hwd_latency_notify_workspace_switch(void);
+
+void
+hwd_latency_notify_workspace_switch_applied(void);
+
+struct hwd_latency_output *
+hwd_latency_output_create(const char *name);
+
+void
+hwd_latency_output_destroy(struct hwd_latency_output *output);
+
+void
+hwd_latency_output_commit(struct hwd_latency_output *output);
+
+void
+hwd_latency_output_present(
+    struct hwd_latency_output *output, const struct timespec *when, int refresh_nsec
+);
+
+void
+hwd_latency_output_discard(struct hwd_latency_output *output);
+
+/**
+ * Logs the histograms of every output and returns the same report as a newly
+ * allocated string, or NULL if it could not be allocated.
+ */
+char *
+hwd_latency_dump(void);
+
+void
+hwd_latency_reset(void);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef HWD_LAUNCHER_H
+#define HWD_LAUNCHER_H
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/**
+ * Runs commands on behalf of `exec`.
+ *
+ * A small helper process is forked from the compositor during startup, before
+ * the renderer and the tree are created, and runs each command with `sh -c` in
+ * a new session.  Forking the helper stays cheap however much memory the
+ * compositor has mapped.  The compositor's environment is sent along with each
+ * command, as it changes after the helper is started.
+ *
+ * If the helper is not running, commands are run by forking the compositor.
+ */
+bool
+hwd_launcher_init(void);
+
+void
+hwd_launcher_finish(void);
+
+/**
+ * Returns the pid of the process running `cmd`, or -1 on failure.  The process
+ * is not a child of the compositor and does not need to be reaped.
+ */
+pid_t
+hwd_launcher_spawn(const char *cmd);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef HWD_LIST_H
 #define HWD_LIST_H
 
+#include <stdbool.h>
+
 typedef struct {
     int capacity;
     int length;
@@ -23,6 +25,15 @@ void
 list_clear(list_t *list);
 void
 list_cat(list_t *list, list_t *source);
+// Ensures that `item` is at `index`, which must be no greater than the length
+// of the list.  If a different item is there then it, and everything after it,
+// is discarded before `item` is appended.  Returns true if the list changed.
+bool
+list_update(list_t *list, int index, void *item);
+// Discards any items after the first `length`.  Returns true if the list
+// changed.
+bool
+list_truncate(list_t *list, int length);
 // See qsort. Remember to use *_qsort functions as compare functions,
 // because they dereference the left and right arguments first!
 void
@@ -1,6 +1,12 @@
 #ifndef HWD_PROFILER_H
 #define HWD_PROFILER_H
 
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
 #ifdef HAVE_SYSPROF
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -13,8 +19,43 @@ typedef uint64_t hwd_timestamp;
 struct hwd_profiler_span {
     hwd_timestamp begin;
     const char *message;
+    bool stacked;
 };
 
+#define HWD_PROFILER_STACK_SIZE 64
+
+/**
+ * Stack of spans currently open on the main thread.  Written only by the main
+ * thread, but may be read concurrently by the watchdog thread to report what
+ * the compositor was doing when it stalled.  Spans nested deeper than
+ * `HWD_PROFILER_STACK_SIZE` are counted but not recorded.
+ */
+struct hwd_profiler_stack {
+    atomic_size_t depth;
+    struct {
+        _Atomic(const char *) message;
+        _Atomic hwd_timestamp begin;
+    } spans[HWD_PROFILER_STACK_SIZE];
+};
+
+extern struct hwd_profiler_stack hwd_profiler_stack;
+
+/**
+ * Set while a watchdog is running.  Spans are only pushed to the stack, and
+ * only timed if sysprof is not available, when something is there to read
+ * them.
+ */
+extern bool hwd_profiler_stack_enabled;
+
+/**
+ * Returns the number of heap allocations made by the process so far, or zero
+ * if no allocation counter is available.  Counting is provided by preloading a
+ * library that exports `hwd_bench_allocation_count`, as the benchmark harness
+ * does.
+ */
+size_t
+hwd_profiler_allocation_count(void);
+
 static inline void
 hwd_profiler_init(void) {
 #ifdef HAVE_SYSPROF
@@ -27,7 +68,9 @@ hwd_profiler_now(void) {
 #ifdef HAVE_SYSPROF
     return SYSPROF_CAPTURE_CURRENT_TIME;
 #else
-    return 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (hwd_timestamp)now.tv_sec * 1000000000 + (hwd_timestamp)now.tv_nsec;
 #endif
 }
 
@@ -46,14 +89,51 @@ hwd_profiler_mark(const char *message, hwd_timestamp begin, hwd_timestamp end) {
 #define HWD_PROFILER_TRACE_SPAN_NAME_(func, line) HWD_PROFILER_TRACE_SPAN_NAME_INNER_(func, line)
 #define HWD_PROFILER_TRACE()                                                                       \
     __attribute__((cleanup(hwd_profiler_span_cleanup__))                                           \
-    ) struct hwd_profiler_span HWD_PROFILER_TRACE_SPAN_NAME_(__func__, __LINE__) = {               \
-        .begin = hwd_profiler_now(), .message = __func__                                           \
-    };                                                                                             \
+    ) struct hwd_profiler_span HWD_PROFILER_TRACE_SPAN_NAME_(__func__, __LINE__) =                 \
+        hwd_profiler_span_begin__(__func__);                                                       \
     (void)HWD_PROFILER_TRACE_SPAN_NAME_(__func__, __LINE__)
 
+static inline struct hwd_profiler_span
+hwd_profiler_span_begin__(const char *message) {
+    struct hwd_profiler_span span = {.message = message};
+
+#ifdef HAVE_SYSPROF
+    span.begin = hwd_profiler_now();
+#endif
+
+    if (!hwd_profiler_stack_enabled) {
+        return span;
+    }
+    span.stacked = true;
+
+#ifndef HAVE_SYSPROF
+    span.begin = hwd_profiler_now();
+#endif
+
+    size_t depth = atomic_load_explicit(&hwd_profiler_stack.depth, memory_order_relaxed);
+    if (depth < HWD_PROFILER_STACK_SIZE) {
+        atomic_store_explicit(
+            &hwd_profiler_stack.spans[depth].message, message, memory_order_relaxed
+        );
+        atomic_store_explicit(
+            &hwd_profiler_stack.spans[depth].begin, span.begin, memory_order_relaxed
+        );
+    }
+    atomic_store_explicit(&hwd_profiler_stack.depth, depth + 1, memory_order_release);
+
+    return span;
+}
+
 static inline void
 hwd_profiler_span_cleanup__(struct hwd_profiler_span *span) {
+    if (span->stacked) {
+        size_t depth = atomic_load_explicit(&hwd_profiler_stack.depth, memory_order_relaxed);
+        atomic_store_explicit(&hwd_profiler_stack.depth, depth - 1, memory_order_release);
+    }
+
+#ifdef HAVE_SYSPROF
     hwd_profiler_mark(span->message, span->begin, hwd_profiler_now());
+#endif
 }
 
 #endif
@@ -0,0 +1,61 @@
+#ifndef HWD_RECORDER_H
+#define HWD_RECORDER_H
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <wlr/types/wlr_output_layout.h>
+
+/**
+ * Records the events that drive the tree to a compact binary log so that they
+ * can later be replayed against the headless backend.
+ *
+ * A log starts with `HWD_RECORDER_MAGIC` and is followed by a sequence of
+ * records.  Each record is a type byte, the time since the previous record in
+ * microseconds, and a type-specific payload.  All integers are encoded as
+ * LEB128 varints, signed integers after a zigzag transform, and strings as a
+ * length followed by the bytes of the string.
+ */
+
+#define HWD_RECORDER_MAGIC "HWDREC\0\1"
+#define HWD_RECORDER_MAGIC_SIZE 8
+
+enum hwd_recorder_record_type {
+    // Payload: command string.
+    HWD_RECORDER_COMMAND = 1,
+    // Payload: window id.
+    HWD_RECORDER_WINDOW_MAP = 2,
+    // Payload: window id.
+    HWD_RECORDER_WINDOW_UNMAP = 3,
+    // Payload: window id, microseconds taken to acknowledge the configure.
+    HWD_RECORDER_WINDOW_CONFIGURE = 4,
+    // Payload: number of outputs, then for each output its signed x and y
+    // position, width and height in pixels, and scale multiplied by 1000.
+    HWD_RECORDER_OUTPUT_LAYOUT = 5,
+};
+
+bool
+hwd_recorder_open(const char *path);
+
+void
+hwd_recorder_close(void);
+
+void
+hwd_recorder_command(const char *command);
+
+void
+hwd_recorder_window_map(size_t window_id);
+
+void
+hwd_recorder_window_unmap(size_t window_id);
+
+void
+hwd_recorder_window_configure(size_t window_id, uint64_t latency_nsec);
+
+void
+hwd_recorder_output_layout(struct wlr_output_layout *output_layout);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef HWD_REPLAY_H
+#define HWD_REPLAY_H
+
+#include <config.h>
+
+#include <stdbool.h>
+
+#include <wayland-server-core.h>
+
+/**
+ * Replays a log written by the recorder.
+ *
+ * Commands are executed and output layouts applied directly by the
+ * compositor.  Windows are mapped, unmapped and configured by a helper client,
+ * spawned from `client_command`, which reads one instruction per line on its
+ * standard input and writes a line back once each map or unmap has completed.
+ *
+ * Records are either replayed with the timing they were recorded with or, if
+ * `fast` is set, each as soon as the compositor has settled after the last.
+ * "Replay finished" is logged once the log has been exhausted.
+ */
+struct hwd_replay;
+
+struct hwd_replay *
+hwd_replay_create(
+    struct wl_event_loop *event_loop, const char *path, const char *client_command, bool fast
+);
+
+void
+hwd_replay_destroy(struct hwd_replay *replay);
+
+#endif
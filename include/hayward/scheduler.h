@@ -10,6 +10,8 @@
 
 #include <wlr/types/wlr_scene.h>
 
+#include <hayward/latency.h>
+
 struct hwd_scene_output_scheduler {
     struct wlr_scene_output *scene_output;
 
@@ -23,6 +25,8 @@ struct hwd_scene_output_scheduler {
     uint32_t refresh_nsec;
     int max_render_time; // In milliseconds
     struct wl_event_source *repaint_timer;
+
+    struct hwd_latency_output *latency;
 };
 
 struct hwd_scene_output_scheduler *
@@ -27,6 +27,7 @@
 #include <hayward/desktop/xdg_decoration.h>
 #include <hayward/desktop/xdg_shell.h>
 #include <hayward/desktop/xwayland.h>
+#include <hayward/ipc.h>
 
 struct hwd_server {
     struct wl_display *wl_display;
@@ -73,6 +74,9 @@ struct hwd_server {
     struct wlr_pointer_constraints_v1 *pointer_constraints;
     struct wl_listener pointer_constraint;
 
+    struct wlr_cursor_shape_manager_v1 *cursor_shape_manager;
+    struct wl_listener request_set_cursor_shape;
+
     struct {
         bool locked;
         struct wlr_session_lock_manager_v1 *manager;
@@ -91,9 +95,21 @@ struct hwd_server {
 
     struct hwd_xdg_activation_v1 *xdg_activation_v1;
 
+    struct hwd_ipc *ipc;
+
     // The timeout for transactions, after which a transaction is applied
     // regardless of readiness.
     size_t txn_timeout_ms;
+
+    // If non-zero, a watchdog thread reports any stall of the main loop
+    // longer than this.
+    int watchdog_timeout_ms;
+
+    // If set, the recording at `replay_path` is replayed once the compositor
+    // starts, with windows provided by a client spawned from `replay_client`.
+    char *replay_path;
+    char *replay_client;
+    bool replay_fast;
 };
 
 extern struct hwd_server server;
@@ -101,6 +117,8 @@ extern struct hwd_server server;
 struct hwd_debug {
     bool noatomic; // Ignore atomic layout updates
     bool txn_wait; // Always wait for the timeout before applying
+    bool txn_stats; // Log timings for every transaction and frame
+    bool validate; // Validate the whole tree, not just dirty nodes, on commit
 };
 
 extern struct hwd_debug debug;
@@ -128,5 +146,7 @@ void
 hwd_session_lock_init(void);
 void
 handle_pointer_constraint(struct wl_listener *listener, void *data);
+void
+handle_request_set_cursor_shape(struct wl_listener *listener, void *data);
 
 #endif
@@ -27,6 +27,10 @@ struct hwd_column_state {
     bool is_last_child;
 
     list_t *children; // struct hwd_window
+    // Incremented whenever `children` changes in the pending state.  States
+    // with the same generation have the same children, so copying between
+    // them can skip the list.
+    size_t children_generation;
 
     // Whether the column should render a preview of the effect of inserting a
     // new window.  `preview_target` is an optional pointer to a child window
@@ -104,6 +108,13 @@ column_consider_destroy(struct hwd_column *column);
 void
 column_set_dirty(struct hwd_column *column);
 
+/**
+ * Returns the column that `listener` belongs to if it is the listener added to
+ * the transaction commit event by `column_set_dirty`, or NULL otherwise.
+ */
+struct hwd_column *
+column_from_transaction_commit_listener(struct wl_listener *listener);
+
 void
 column_arrange(struct hwd_column *column);
 
@@ -0,0 +1,86 @@
+#ifndef HWD_TREE_LAYOUT_H
+#define HWD_TREE_LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Layout math for the tiling tree.
+ *
+ * These functions operate on plain arrays and have no dependency on the rest
+ * of the tree, or on wlroots, so that they can be linked into standalone tests
+ * and benchmarks.  The tree is responsible for copying state in and out.
+ */
+
+struct hwd_layout_column {
+    // Fraction of the output's width allocated to this column.  Columns with a
+    // fraction of zero or less are new, and are given the average fraction of
+    // the existing columns.  Fractions are normalised to sum to one in place.
+    double width_fraction;
+
+    // Outputs.
+    double x;
+    double width;
+};
+
+/**
+ * Divides the area between `x` and `x + width` between `columns`, separated by
+ * `gap`.  The last column absorbs any rounding error so that the columns
+ * exactly fill the area.  Returns the total width available to columns,
+ * excluding gaps.
+ */
+double
+hwd_layout_arrange_columns(
+    double x, double width, double gap, struct hwd_layout_column *columns, size_t num_columns
+);
+
+struct hwd_layout_window {
+    // Inputs.  Fullscreen windows are skipped and their outputs left
+    // untouched.
+    double height_fraction;
+    double titlebar_height;
+    bool fullscreen;
+
+    // Outputs.
+    double y;
+    double height;
+    bool shaded;
+};
+
+struct hwd_layout_preview {
+    // Inputs.  If `show` is false then the remaining fields are ignored.
+    bool show;
+    double height_fraction;
+    double baseline;
+    double anchor_y;
+    double titlebar_height;
+
+    // Outputs.  The preview is inserted before the window at `index`, or after
+    // the last window if `index` is equal to the number of windows.
+    size_t index;
+    double y;
+    double height;
+};
+
+/**
+ * Divides the vertical space between `y` and `y + height` between `windows` in
+ * proportion to their height fractions.
+ */
+void
+hwd_layout_arrange_split(
+    double y, double height, struct hwd_layout_window *windows, size_t num_windows,
+    struct hwd_layout_preview *preview
+);
+
+/**
+ * Gives all of the vertical space between `y` and `y + height` that is not
+ * taken up by titlebars to the window at `active`.  All other windows are
+ * shaded.  Passing an index past the end of `windows` shades every window.
+ */
+void
+hwd_layout_arrange_stacked(
+    double y, double height, struct hwd_layout_window *windows, size_t num_windows,
+    size_t active, struct hwd_layout_preview *preview
+);
+
+#endif
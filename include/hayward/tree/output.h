@@ -47,6 +47,15 @@ struct hwd_output {
     // last window on the current workspace in this list.
     list_t *fullscreen_windows; // struct hwd_window
 
+    // All live windows for which this is the current output.  Maintained by
+    // `window_set_output`.
+    list_t *windows; // struct hwd_window
+
+    // Range of the columns on this output in the scratch space of the
+    // workspace being arranged.  Only meaningful while it is being arranged.
+    size_t arrange_start;
+    size_t arrange_length;
+
     bool dirty;
     bool dead;
 
@@ -56,6 +65,8 @@ struct hwd_output {
 
     struct wl_list shell_layers[4]; // hwd_layer_surface::link
     struct wlr_box usable_area;
+    // Full area that layer surfaces were last arranged within.
+    struct wlr_box layers_area;
 
     enum wl_output_subpixel detected_subpixel;
     enum scale_filter_mode scale_filter;
@@ -103,9 +114,19 @@ output_consider_destroy(struct hwd_output *output);
 void
 output_set_dirty(struct hwd_output *output);
 
+/**
+ * Returns the output that `listener` belongs to if it is the listener added to
+ * the transaction commit event by `output_set_dirty`, or NULL otherwise.
+ */
+struct hwd_output *
+output_from_transaction_commit_listener(struct wl_listener *listener);
+
 void
 output_reconcile(struct hwd_output *output);
 
+void
+output_arrange_layers(struct hwd_output *output);
+
 void
 output_arrange(struct hwd_output *output);
 
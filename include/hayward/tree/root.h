@@ -47,6 +47,10 @@ struct hwd_root {
 
     bool dirty;
 
+    // Set when output geometry changes.  Causes inactive workspaces to be
+    // arranged in the background on the next transaction.
+    bool hidden_workspaces_dirty;
+
     struct hwd_transaction_manager *transaction_manager;
 
     list_t *workspaces;
@@ -49,6 +49,11 @@ struct hwd_transaction_manager {
     hwd_timestamp begin_transaction;
     hwd_timestamp begin_waiting_confirm;
 
+    // Only tracked when `debug.txn_stats` is set.
+    hwd_timestamp before_commit_duration;
+    hwd_timestamp commit_duration;
+    size_t begin_allocations;
+
     struct {
         struct wl_signal before_commit;
         struct wl_signal commit;
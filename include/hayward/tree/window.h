@@ -14,6 +14,7 @@
 
 #include <hayward/config.h>
 #include <hayward/list.h>
+#include <hayward/profiler.h>
 #include <hayward/theme.h>
 
 #define MIN_SANE_W 100
@@ -124,6 +125,7 @@ struct hwd_window {
     bool resizing;
 
     bool is_configuring;
+    hwd_timestamp begin_configure;
 
     char *title;
 
@@ -152,6 +154,7 @@ struct hwd_window {
         struct wlr_scene_node *titlebar;
         struct wlr_scene_node *titlebar_text;
         struct wlr_scene_node *titlebar_button_close;
+        // NULL while the window is shaded.
         struct wlr_scene_node *border;
 
         struct wlr_scene_tree *content_tree;
@@ -200,6 +203,13 @@ window_begin_destroy(struct hwd_window *window);
 void
 window_set_dirty(struct hwd_window *window);
 
+/**
+ * Returns the window that `listener` belongs to if it is the listener added to
+ * the transaction commit event by `window_set_dirty`, or NULL otherwise.
+ */
+struct hwd_window *
+window_from_transaction_commit_listener(struct wl_listener *listener);
+
 void
 window_detach(struct hwd_window *window);
 
@@ -301,6 +311,9 @@ floating_calculate_constraints(
 void
 window_floating_move_to(struct hwd_window *window, struct hwd_output *output, double lx, double ly);
 
+void
+window_set_output(struct hwd_window *window, struct hwd_output *output);
+
 struct hwd_output *
 window_get_output(struct hwd_window *window);
 
@@ -18,12 +18,18 @@ enum hwd_focus_mode {
     F_FLOATING,
 };
 
+struct hwd_layout_column;
 struct hwd_view;
 
 struct hwd_workspace_state {
     list_t *floating; // struct hwd_window
     list_t *columns;  // struct hwd_column
 
+    // Incremented whenever the corresponding list changes in the pending
+    // state.  See `hwd_column_state::children_generation`.
+    size_t floating_generation;
+    size_t columns_generation;
+
     bool focused;
 
     bool dead;
@@ -54,6 +60,12 @@ struct hwd_workspace {
 
     enum hwd_focus_mode focus_mode;
 
+    // Scratch space used when arranging columns, grouped by output.  Grown as
+    // needed and kept so that arranging does not allocate.
+    struct hwd_column **arrange_columns;
+    struct hwd_layout_column *arrange_layout_columns;
+    size_t arrange_capacity;
+
     struct hwd_workspace_handle_v1 *workspace_handle;
 
     struct wlr_scene_tree *scene_tree;
@@ -0,0 +1,25 @@
+#ifndef HWD_WATCHDOG_H
+#define HWD_WATCHDOG_H
+
+#include <config.h>
+
+#include <wayland-server-core.h>
+
+/**
+ * Detects stalls of the main event loop.
+ *
+ * A timer on the event loop records when the next heartbeat is due, every half
+ * timeout.  A separate thread sleeps until that heartbeat is overdue by the
+ * timeout and, if it still has not arrived, logs the stack of profiler spans
+ * that are currently open on the main thread.  Once the loop recovers, the total
+ * length of the stall is logged from the main thread.
+ */
+struct hwd_watchdog;
+
+struct hwd_watchdog *
+hwd_watchdog_create(struct wl_event_loop *event_loop, int timeout_ms);
+
+void
+hwd_watchdog_destroy(struct hwd_watchdog *watchdog);
+
+#endif
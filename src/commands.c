@@ -21,6 +21,7 @@
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
 #include <hayward/list.h>
+#include <hayward/recorder.h>
 #include <hayward/stringop.h>
 #include <hayward/tree/root.h>
 #include <hayward/tree/window.h>
@@ -71,6 +72,7 @@ static const struct cmd_handler handlers[] = {
     {"font", cmd_font},
     {"force_display_urgency_hint", cmd_force_display_urgency_hint},
     {"fullscreen", cmd_fullscreen},
+    {"hidden_frame_rate", cmd_hidden_frame_rate},
     {"input", cmd_input},
     {"mode", cmd_mode},
     {"seat", cmd_seat},
@@ -95,6 +97,7 @@ static const struct cmd_handler command_handlers[] = {
     {"floating", cmd_floating},     //
     {"fullscreen", cmd_fullscreen}, //
     {"kill", cmd_kill},             //
+    {"latency", cmd_latency},       //
     {"layout", cmd_layout},         //
     {"move", cmd_move},             //
     {"nop", cmd_nop},               //
@@ -179,6 +182,7 @@ execute_command(char *_exec, struct hwd_seat *seat, struct hwd_window *window) {
             continue;
         }
         wlr_log(WLR_INFO, "Handling command '%s'", cmd);
+        hwd_recorder_command(cmd);
         // TODO better handling of argv
         int argc;
         char **argv = split_args(cmd, &argc);
@@ -498,6 +498,11 @@ cmd_bindsym_or_bindcode(int argc, char **argv, bool bindcode, bool unbind) {
         mode_bindings = config->current_mode->mouse_bindings;
     }
 
+    if (mode_bindings == config->current_mode->mouse_bindings) {
+        binding_index_destroy(config->current_mode->mouse_binding_index);
+        config->current_mode->mouse_binding_index = NULL;
+    }
+
     if (unbind) {
         return binding_remove(binding, mode_bindings, bindtype, argv[0]);
     }
@@ -796,3 +801,121 @@ binding_add_translated(struct hwd_binding *binding, list_t *mode_bindings) {
         free_hwd_binding(config_binding);
     }
 }
+
+struct hwd_binding_index {
+    // Open addressed table with linear probing.  Bindings that share a key
+    // are inserted along the same probe sequence, so are found in insertion
+    // order.
+    size_t mask;
+    struct hwd_binding_index_slot {
+        uint32_t hash;
+        struct hwd_binding *binding;
+    } *slots;
+};
+
+static uint32_t
+binding_index_hash(uint32_t modifiers, bool release, const uint32_t *keys, size_t num_keys) {
+    // FNV-1a.
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ modifiers) * 16777619u;
+    hash = (hash ^ (release ? 1 : 0)) * 16777619u;
+    for (size_t i = 0; i < num_keys; i++) {
+        hash = (hash ^ keys[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool
+binding_index_matches(
+    struct hwd_binding *binding, uint32_t modifiers, bool release, const uint32_t *keys,
+    size_t num_keys
+) {
+    if (binding->modifiers != modifiers || ((binding->flags & BINDING_RELEASE) != 0) != release ||
+        (size_t)binding->keys->length != num_keys) {
+        return false;
+    }
+    for (size_t i = 0; i < num_keys; i++) {
+        if (*(uint32_t *)binding->keys->items[i] != keys[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct hwd_binding_index *
+binding_index_create(list_t *bindings) {
+    struct hwd_binding_index *index = calloc(1, sizeof(struct hwd_binding_index));
+    if (index == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate binding index");
+        return NULL;
+    }
+
+    // Keep the table at most half full.
+    size_t capacity = 8;
+    while (capacity < (size_t)bindings->length * 2) {
+        capacity *= 2;
+    }
+    index->mask = capacity - 1;
+    index->slots = calloc(capacity, sizeof(struct hwd_binding_index_slot));
+    if (index->slots == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate binding index");
+        free(index);
+        return NULL;
+    }
+
+    uint32_t keys[HWD_CURSOR_PRESSED_BUTTONS_CAP];
+    for (int i = 0; i < bindings->length; i++) {
+        struct hwd_binding *binding = bindings->items[i];
+
+        size_t num_keys = binding->keys->length;
+        if (num_keys > HWD_CURSOR_PRESSED_BUTTONS_CAP) {
+            // Can never be triggered.
+            continue;
+        }
+        for (size_t j = 0; j < num_keys; j++) {
+            keys[j] = *(uint32_t *)binding->keys->items[j];
+        }
+
+        uint32_t hash = binding_index_hash(
+            binding->modifiers, binding->flags & BINDING_RELEASE, keys, num_keys
+        );
+        size_t slot = hash & index->mask;
+        while (index->slots[slot].binding != NULL) {
+            slot = (slot + 1) & index->mask;
+        }
+        index->slots[slot].hash = hash;
+        index->slots[slot].binding = binding;
+    }
+
+    return index;
+}
+
+void
+binding_index_destroy(struct hwd_binding_index *index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->slots);
+    free(index);
+}
+
+struct hwd_binding *
+binding_index_next(
+    struct hwd_binding_index *index, uint32_t modifiers, bool release, const uint32_t *keys,
+    size_t num_keys, size_t *iter
+) {
+    uint32_t hash = binding_index_hash(modifiers, release, keys, num_keys);
+
+    for (; *iter <= index->mask; (*iter)++) {
+        struct hwd_binding_index_slot *slot = &index->slots[(hash + *iter) & index->mask];
+        if (slot->binding == NULL) {
+            break;
+        }
+        if (slot->hash == hash &&
+            binding_index_matches(slot->binding, modifiers, release, keys, num_keys)) {
+            (*iter)++;
+            return slot->binding;
+        }
+    }
+    return NULL;
+}
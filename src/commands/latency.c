@@ -0,0 +1,45 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/commands.h"
+
+#include <stdlib.h>
+#include <strings.h>
+
+#include <hayward/latency.h>
+#include <hayward/profiler.h>
+
+struct cmd_results *
+cmd_latency(int argc, char **argv) {
+    HWD_PROFILER_TRACE();
+
+    struct cmd_results *error = NULL;
+    if ((error = checkarg(argc, "latency", EXPECTED_EQUAL_TO, 1))) {
+        return error;
+    }
+
+    if (strcasecmp(argv[0], "dump") == 0) {
+        char *report = hwd_latency_dump();
+        if (report == NULL) {
+            return cmd_results_new(CMD_FAILURE, "Unable to allocate latency report");
+        }
+
+        // The report can be longer than the messages that `cmd_results_new`
+        // formats, so hand it over directly.
+        struct cmd_results *results = cmd_results_new(CMD_SUCCESS, NULL);
+        if (results == NULL) {
+            free(report);
+            return NULL;
+        }
+        results->error = report;
+        return results;
+    } else if (strcasecmp(argv[0], "reset") == 0) {
+        hwd_latency_reset();
+    } else {
+        return cmd_results_new(CMD_INVALID, "Expected 'latency dump|reset'");
+    }
+
+    return cmd_results_new(CMD_SUCCESS, NULL);
+}
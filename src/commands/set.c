@@ -9,18 +9,9 @@
 #include <string.h>
 
 #include <hayward/config.h>
-#include <hayward/list.h>
 #include <hayward/profiler.h>
 #include <hayward/stringop.h>
 
-// sort in order of longest->shortest
-static int
-compare_set_qsort(const void *_l, const void *_r) {
-    struct hwd_variable const *l = *(void **)_l;
-    struct hwd_variable const *r = *(void **)_r;
-    return strlen(r->name) - strlen(l->name);
-}
-
 void
 free_hwd_variable(struct hwd_variable *var) {
     if (!var) {
@@ -44,16 +35,7 @@ cmd_set(int argc, char **argv) {
         return cmd_results_new(CMD_INVALID, "variable '%s' must start with $", argv[0]);
     }
 
-    struct hwd_variable *var = NULL;
-    // Find old variable if it exists
-    int i;
-    for (i = 0; i < config->symbols->length; ++i) {
-        var = config->symbols->items[i];
-        if (strcmp(var->name, argv[0]) == 0) {
-            break;
-        }
-        var = NULL;
-    }
+    struct hwd_variable *var = config_get_variable(config, argv[0]);
     if (var) {
         free(var->value);
     } else {
@@ -62,8 +44,7 @@ cmd_set(int argc, char **argv) {
             return cmd_results_new(CMD_FAILURE, "Unable to allocate variable");
         }
         var->name = strdup(argv[0]);
-        list_add(config->symbols, var);
-        list_qsort(config->symbols, compare_set_qsort);
+        config_add_variable(config, var);
     }
     var->value = join_args(argv + 1, argc - 1);
     return cmd_results_new(CMD_SUCCESS, NULL);
@@ -6,11 +6,14 @@
 #include "hayward/config.h"
 
 #include <assert.h>
+#include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <libgen.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,15 +38,13 @@
 #include <hayward/input/switch.h>
 #include <hayward/list.h>
 #include <hayward/pango.h>
+#include <hayward/profiler.h>
 #include <hayward/server.h>
 #include <hayward/stringop.h>
 #include <hayward/tree/root.h>
 
 struct hwd_config *config = NULL;
 
-static bool
-read_config(FILE *file, struct hwd_config *config, struct haywardnag_instance *haywardnag);
-
 static struct xkb_state *
 keysym_translation_state_create(struct xkb_rule_names rules) {
     struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
@@ -84,6 +85,7 @@ free_mode(struct hwd_mode *mode) {
         }
         list_free(mode->mouse_bindings);
     }
+    binding_index_destroy(mode->mouse_binding_index);
     if (mode->switch_bindings) {
         for (int i = 0; i < mode->switch_bindings->length; i++) {
             free_switch_binding(mode->switch_bindings->items[i]);
@@ -150,7 +152,7 @@ config_defaults(struct hwd_config *config) {
     if (!(config->cmd_queue = create_list()))
         goto cleanup;
 
-    if (!(config->current_mode = malloc(sizeof(struct hwd_mode))))
+    if (!(config->current_mode = calloc(1, sizeof(struct hwd_mode))))
         goto cleanup;
     if (!(config->current_mode->name = malloc(sizeof("default"))))
         goto cleanup;
@@ -190,6 +192,7 @@ config_defaults(struct hwd_config *config) {
     config->reading = false;
     config->show_marks = true;
     config->tiling_drag_threshold = 9;
+    config->hidden_frame_rate = 1;
 
     if (!(config->config_chain = create_list()))
         goto cleanup;
@@ -273,6 +276,309 @@ get_config_path(void) {
     return path;
 }
 
+struct config_line {
+    // Number of the last physical line consumed, including continuations and
+    // an opening brace on a following line.
+    int line_number;
+
+    // Whether the line was followed by a line containing only `{`.
+    bool brace;
+
+    // Stripped line, with continuations joined.
+    char *text;
+};
+
+struct config_fragment {
+    // Key.  A fragment is reused only if the file it was read from has not
+    // been replaced or modified since.
+    char *path;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    struct timespec ctime;
+
+    // Set when the fragment is read during a load, and cleared when unused
+    // fragments are pruned at the end.
+    bool used;
+
+    // Backing storage for the text of all lines.
+    char *text;
+
+    struct config_line *lines;
+    size_t num_lines;
+
+    struct wl_list link; // config_fragment_cache
+};
+
+// Tokenized include files, kept across reloads.
+static struct wl_list config_fragment_cache = {&config_fragment_cache, &config_fragment_cache};
+
+static void
+config_fragment_destroy(struct config_fragment *fragment) {
+    if (fragment == NULL) {
+        return;
+    }
+    free(fragment->path);
+    free(fragment->text);
+    free(fragment->lines);
+    free(fragment);
+}
+
+static bool
+config_fragment_matches(struct config_fragment *fragment, const struct stat *sb) {
+    return fragment->dev == sb->st_dev && fragment->ino == sb->st_ino &&
+        fragment->size == sb->st_size && fragment->mtime.tv_sec == sb->st_mtim.tv_sec &&
+        fragment->mtime.tv_nsec == sb->st_mtim.tv_nsec &&
+        fragment->ctime.tv_sec == sb->st_ctim.tv_sec &&
+        fragment->ctime.tv_nsec == sb->st_ctim.tv_nsec;
+}
+
+static void
+config_fragment_cache_prune(void) {
+    struct config_fragment *fragment, *tmp;
+    wl_list_for_each_safe(fragment, tmp, &config_fragment_cache, link) {
+        if (!fragment->used) {
+            wl_list_remove(&fragment->link);
+            config_fragment_destroy(fragment);
+        } else {
+            fragment->used = false;
+        }
+    }
+}
+
+// Returns the number of physical lines, starting at `*pos`, up to and
+// including the first non-blank line if it contains only `{`, and advances
+// `*pos` past them.  Returns zero, leaving `*pos` untouched, otherwise.
+static int
+config_detect_brace(const char *data, size_t size, size_t *pos) {
+    int lines = 0;
+    size_t next = *pos;
+    while (next < size) {
+        const char *eol = memchr(&data[next], '\n', size - next);
+        size_t end = eol ? (size_t)(eol - data) + 1 : size;
+        lines++;
+
+        size_t start = next;
+        size_t stop = end;
+        while (start < stop && isspace((unsigned char)data[start])) {
+            start++;
+        }
+        while (stop > start && isspace((unsigned char)data[stop - 1])) {
+            stop--;
+        }
+        next = end;
+
+        if (start == stop) {
+            continue;
+        }
+        if (stop - start == 1 && data[start] == '{') {
+            *pos = next;
+            return lines;
+        }
+        return 0;
+    }
+    return 0;
+}
+
+static bool
+config_fragment_add_line(
+    struct config_fragment *fragment, size_t *capacity, struct config_line line
+) {
+    if (fragment->num_lines == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 64;
+        struct config_line *lines =
+            realloc(fragment->lines, new_capacity * sizeof(struct config_line));
+        if (lines == NULL) {
+            return false;
+        }
+        fragment->lines = lines;
+        *capacity = new_capacity;
+    }
+    fragment->lines[fragment->num_lines++] = line;
+    return true;
+}
+
+// Splits `data` into commands in a single pass.  Lines ending in a backslash
+// are joined with the line that follows unless they are comments, blank lines
+// and comments are dropped, and an opening brace on a line of its own is
+// folded into the line before it.  Lines are never longer than the input they
+// were read from, so all of them fit in one buffer of `size + 1` bytes.
+static bool
+config_fragment_tokenize(struct config_fragment *fragment, const char *data, size_t size) {
+    fragment->text = malloc(size + 1);
+    if (fragment->text == NULL) {
+        return false;
+    }
+
+    size_t capacity = 0;
+    size_t text_length = 0;
+    size_t pos = 0;
+    int line_number = 0;
+    while (pos < size) {
+        char *line = &fragment->text[text_length];
+        size_t length = 0;
+        while (true) {
+            const char *eol = memchr(&data[pos], '\n', size - pos);
+            size_t end = eol ? (size_t)(eol - data) + 1 : size;
+            memcpy(&line[length], &data[pos], end - pos);
+            length += end - pos;
+            pos = end;
+            line_number++;
+
+            if (pos < size && length >= 2 && line[0] != '#' && line[length - 2] == '\\' &&
+                line[length - 1] == '\n') {
+                length -= 2;
+                continue;
+            }
+            break;
+        }
+
+        if (length > 0 && line[length - 1] == '\n') {
+            length--;
+        }
+        line[length] = '\0';
+
+        strip_whitespace(line);
+        if (!*line || line[0] == '#') {
+            continue;
+        }
+        length = strlen(line);
+
+        bool brace = false;
+        if (line[length - 1] != '{' && line[length - 1] != '}') {
+            int brace_lines = config_detect_brace(data, size, &pos);
+            line_number += brace_lines;
+            brace = brace_lines > 0;
+        }
+
+        struct config_line config_line = {
+            .line_number = line_number,
+            .brace = brace,
+            .text = line,
+        };
+        if (!config_fragment_add_line(fragment, &capacity, config_line)) {
+            return false;
+        }
+        text_length += length + 1;
+    }
+
+    return true;
+}
+
+// Reads and tokenizes the file open on `fd`.  If `contents` is not NULL then it
+// is set to a copy of the raw contents of the file.
+static struct config_fragment *
+config_fragment_read(int fd, const struct stat *sb, char **contents) {
+    // Regular files are normally read in a single call.  The buffer is one
+    // byte larger than the file so that reaching the end doesn't need another
+    // allocation.
+    size_t capacity = S_ISREG(sb->st_mode) ? (size_t)sb->st_size + 1 : 4096;
+    size_t size = 0;
+    char *data = malloc(capacity);
+    if (data == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate buffer for config contents");
+        return NULL;
+    }
+
+    while (true) {
+        if (size == capacity) {
+            capacity *= 2;
+            char *new_data = realloc(data, capacity);
+            if (new_data == NULL) {
+                wlr_log(WLR_ERROR, "Unable to allocate buffer for config contents");
+                free(data);
+                return NULL;
+            }
+            data = new_data;
+        }
+        ssize_t nread = read(fd, &data[size], capacity - size);
+        if (nread < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            wlr_log_errno(WLR_ERROR, "Unable to read config file");
+            free(data);
+            return NULL;
+        }
+        if (nread == 0) {
+            break;
+        }
+        size += nread;
+    }
+
+    // Fragments are cached by size and modification time, so the contents
+    // must match what was reported by fstat.
+    if (S_ISREG(sb->st_mode) && size != (size_t)sb->st_size) {
+        wlr_log(WLR_ERROR, "Config file changed during reading");
+        free(data);
+        return NULL;
+    }
+
+    struct config_fragment *fragment = calloc(1, sizeof(struct config_fragment));
+    bool success = fragment != NULL && config_fragment_tokenize(fragment, data, size);
+    if (success && contents != NULL) {
+        *contents = malloc(size + 1);
+        if (*contents != NULL) {
+            memcpy(*contents, data, size);
+            (*contents)[size] = '\0';
+        } else {
+            success = false;
+        }
+    }
+
+    free(data);
+
+    if (!success) {
+        wlr_log(WLR_ERROR, "Unable to allocate buffer for config contents");
+        config_fragment_destroy(fragment);
+        return NULL;
+    }
+    return fragment;
+}
+
+static struct config_fragment *
+config_fragment_cache_get(const char *path, int fd, const struct stat *sb) {
+    struct config_fragment *fragment;
+    wl_list_for_each(fragment, &config_fragment_cache, link) {
+        if (strcmp(fragment->path, path) != 0) {
+            continue;
+        }
+        if (config_fragment_matches(fragment, sb)) {
+            fragment->used = true;
+            return fragment;
+        }
+        wl_list_remove(&fragment->link);
+        config_fragment_destroy(fragment);
+        break;
+    }
+
+    fragment = config_fragment_read(fd, sb, NULL);
+    if (fragment == NULL) {
+        return NULL;
+    }
+    fragment->path = strdup(path);
+    if (fragment->path == NULL) {
+        config_fragment_destroy(fragment);
+        return NULL;
+    }
+    fragment->dev = sb->st_dev;
+    fragment->ino = sb->st_ino;
+    fragment->size = sb->st_size;
+    fragment->mtime = sb->st_mtim;
+    fragment->ctime = sb->st_ctim;
+    fragment->used = true;
+    wl_list_insert(&config_fragment_cache, &fragment->link);
+
+    return fragment;
+}
+
+static bool
+read_config(
+    struct config_fragment *fragment, struct hwd_config *config,
+    struct haywardnag_instance *haywardnag
+);
+
 static bool
 load_config(const char *path, struct hwd_config *config, struct haywardnag_instance *haywardnag) {
     if (path == NULL) {
@@ -282,20 +588,41 @@ load_config(const char *path, struct hwd_config *config, struct haywardnag_insta
 
     wlr_log(WLR_INFO, "Loading config from %s", path);
 
-    struct stat sb;
-    if (stat(path, &sb) == 0 && S_ISDIR(sb.st_mode)) {
-        wlr_log(WLR_ERROR, "%s is a directory not a config file", path);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        wlr_log(WLR_ERROR, "Unable to open %s for reading", path);
         return false;
     }
 
-    FILE *f = fopen(path, "r");
-    if (!f) {
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
         wlr_log(WLR_ERROR, "Unable to open %s for reading", path);
+        close(fd);
         return false;
     }
+    if (S_ISDIR(sb.st_mode)) {
+        wlr_log(WLR_ERROR, "%s is a directory not a config file", path);
+        close(fd);
+        return false;
+    }
+
+    // The main config is usually the file that was just edited, so it is
+    // always re-read.  Includes are looked up in the cache.
+    struct config_fragment *fragment;
+    bool cached = config->current_config != NULL;
+    if (cached) {
+        fragment = config_fragment_cache_get(path, fd, &sb);
+    } else {
+        char *contents = NULL;
+        fragment = config_fragment_read(fd, &sb, &contents);
+        config->current_config = contents;
+    }
+    close(fd);
 
-    bool config_load_success = read_config(f, config, haywardnag);
-    fclose(f);
+    bool config_load_success = fragment != NULL && read_config(fragment, config, haywardnag);
+    if (!cached) {
+        config_fragment_destroy(fragment);
+    }
 
     if (!config_load_success) {
         wlr_log(WLR_ERROR, "Error(s) loading config!");
@@ -306,6 +633,8 @@ load_config(const char *path, struct hwd_config *config, struct haywardnag_insta
 
 bool
 load_main_config(const char *file, bool is_active, bool validating) {
+    HWD_PROFILER_TRACE();
+
     char *path;
     if (file != NULL) {
         path = strdup(file);
@@ -359,6 +688,7 @@ load_main_config(const char *file, bool is_active, bool validating) {
     config->reading = true;
 
     bool success = load_config(path, config, &config->haywardnag_config_errors);
+    config_fragment_cache_prune();
 
     if (validating) {
         free_config(config);
@@ -488,61 +818,6 @@ cleanup:
     free(wd);
 }
 
-// get line, with backslash continuation
-static ssize_t
-getline_with_cont(char **lineptr, size_t *line_size, FILE *file, int *nlines) {
-    char *next_line = NULL;
-    size_t next_line_size = 0;
-    ssize_t nread = getline(lineptr, line_size, file);
-    *nlines = nread == -1 ? 0 : 1;
-    while (nread >= 2 && strcmp(&(*lineptr)[nread - 2], "\\\n") == 0 && (*lineptr)[0] != '#') {
-        ssize_t next_nread = getline(&next_line, &next_line_size, file);
-        if (next_nread == -1) {
-            break;
-        }
-        (*nlines)++;
-
-        nread += next_nread - 2;
-        if ((ssize_t)*line_size < nread + 1) {
-            *line_size = nread + 1;
-            char *old_ptr = *lineptr;
-            *lineptr = realloc(*lineptr, *line_size);
-            if (!*lineptr) {
-                free(old_ptr);
-                nread = -1;
-                break;
-            }
-        }
-        strcpy(&(*lineptr)[nread - next_nread], next_line);
-    }
-    free(next_line);
-    return nread;
-}
-
-static int
-detect_brace(FILE *file) {
-    int ret = 0;
-    int lines = 0;
-    long pos = ftell(file);
-    char *line = NULL;
-    size_t line_size = 0;
-    while ((getline(&line, &line_size, file)) != -1) {
-        lines++;
-        strip_whitespace(line);
-        if (*line) {
-            if (strcmp(line, "{") == 0) {
-                ret = lines;
-            }
-            break;
-        }
-    }
-    free(line);
-    if (ret == 0) {
-        fseek(file, pos, SEEK_SET);
-    }
-    return ret;
-}
-
 static char *
 expand_line(const char *block, const char *line, bool add_brace) {
     int size = (block ? strlen(block) + 1 : 0) + strlen(line) + (add_brace ? 2 : 0) + 1;
@@ -559,70 +834,19 @@ expand_line(const char *block, const char *line, bool add_brace) {
 }
 
 static bool
-read_config(FILE *file, struct hwd_config *config, struct haywardnag_instance *haywardnag) {
-    bool reading_main_config = false;
-    char *this_config = NULL;
-    size_t config_size = 0;
-    if (config->current_config == NULL) {
-        reading_main_config = true;
-
-        int ret_seek = fseek(file, 0, SEEK_END);
-        long ret_tell = ftell(file);
-        if (ret_seek == -1 || ret_tell == -1) {
-            wlr_log(WLR_ERROR, "Unable to get size of config file");
-            return false;
-        }
-        config_size = ret_tell;
-        rewind(file);
-
-        config->current_config = this_config = calloc(1, config_size + 1);
-        if (this_config == NULL) {
-            wlr_log(WLR_ERROR, "Unable to allocate buffer for config contents");
-            return false;
-        }
-    }
-
+read_config(
+    struct config_fragment *fragment, struct hwd_config *config,
+    struct haywardnag_instance *haywardnag
+) {
     bool success = true;
-    int line_number = 0;
-    char *line = NULL;
-    size_t line_size = 0;
-    ssize_t nread;
     list_t *stack = create_list();
-    size_t read = 0;
-    int nlines = 0;
-    while ((nread = getline_with_cont(&line, &line_size, file, &nlines)) != -1) {
-        if (reading_main_config) {
-            if (read + nread > config_size) {
-                wlr_log(WLR_ERROR, "Config file changed during reading");
-                success = false;
-                break;
-            }
-
-            strcpy(&this_config[read], line);
-            read += nread;
-        }
+    for (size_t i = 0; i < fragment->num_lines; i++) {
+        struct config_line *config_line = &fragment->lines[i];
+        char *line = config_line->text;
+        int line_number = config_line->line_number;
 
-        if (line[nread - 1] == '\n') {
-            line[nread - 1] = '\0';
-        }
-
-        line_number += nlines;
-        wlr_log(WLR_DEBUG, "Read line %d: %s", line_number, line);
-
-        strip_whitespace(line);
-        if (!*line || line[0] == '#') {
-            continue;
-        }
-        int brace_detected = 0;
-        if (line[strlen(line) - 1] != '{' && line[strlen(line) - 1] != '}') {
-            brace_detected = detect_brace(file);
-            if (brace_detected > 0) {
-                line_number += brace_detected;
-                wlr_log(WLR_DEBUG, "Detected open brace on line %d", line_number);
-            }
-        }
         char *block = stack->length ? stack->items[0] : NULL;
-        char *expanded = expand_line(block, line, brace_detected > 0);
+        char *expanded = expand_line(block, line, config_line->brace);
         if (!expanded) {
             success = false;
             break;
@@ -685,7 +909,6 @@ read_config(FILE *file, struct hwd_config *config, struct haywardnag_instance *h
         free(expanded);
         free_cmd_results(res);
     }
-    free(line);
     list_free_items_and_destroy(stack);
     config->current_config_line_number = 0;
     config->current_config_line = NULL;
@@ -773,6 +996,7 @@ free_config(struct hwd_config *config) {
         }
         list_free(config->symbols);
     }
+    variable_index_destroy(config->symbol_index);
     if (config->modes) {
         for (int i = 0; i < config->modes->length; ++i) {
             free_mode(config->modes->items[i]);
@@ -808,59 +1032,314 @@ free_config(struct hwd_config *config) {
     free(config);
 }
 
-char *
-do_var_replacement(char *str) {
-    int i;
-    char *find = str;
-    while ((find = strchr(find, '$'))) {
-        // Skip if escaped.
-        if (find > str && find[-1] == '\\') {
-            if (find == str + 1 || !(find > str + 1 && find[-2] == '\\')) {
-                ++find;
-                continue;
+struct hwd_variable_index {
+    // Open addressed table of variables, keyed by name.  Kept at most half
+    // full.
+    size_t mask;
+    size_t num_vars;
+    struct hwd_variable_index_slot {
+        uint32_t hash;
+        size_t name_length;
+        struct hwd_variable *var;
+    } *slots;
+
+    // Distinct lengths of variable names, longest first.  Variables are
+    // matched as the longest name that is a prefix of the text following a
+    // `$`, so lookups try each length in turn.
+    size_t *name_lengths;
+    size_t num_name_lengths;
+    size_t name_lengths_capacity;
+};
+
+static uint32_t
+variable_name_hash(const char *name, size_t length) {
+    // FNV-1a.
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void
+variable_index_destroy(struct hwd_variable_index *index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->slots);
+    free(index->name_lengths);
+    free(index);
+}
+
+static void
+variable_index_insert_slot(
+    struct hwd_variable_index_slot *slots, size_t mask, struct hwd_variable_index_slot entry
+) {
+    size_t slot = entry.hash & mask;
+    while (slots[slot].var != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = entry;
+}
+
+static bool
+variable_index_add_name_length(struct hwd_variable_index *index, size_t name_length) {
+    for (size_t i = 0; i < index->num_name_lengths; i++) {
+        if (index->name_lengths[i] == name_length) {
+            return true;
+        }
+    }
+
+    if (index->num_name_lengths == index->name_lengths_capacity) {
+        size_t capacity = index->name_lengths_capacity ? index->name_lengths_capacity * 2 : 8;
+        size_t *name_lengths = realloc(index->name_lengths, capacity * sizeof(size_t));
+        if (name_lengths == NULL) {
+            return false;
+        }
+        index->name_lengths = name_lengths;
+        index->name_lengths_capacity = capacity;
+    }
+
+    size_t i = index->num_name_lengths++;
+    while (i > 0 && index->name_lengths[i - 1] < name_length) {
+        index->name_lengths[i] = index->name_lengths[i - 1];
+        i--;
+    }
+    index->name_lengths[i] = name_length;
+    return true;
+}
+
+static bool
+variable_index_add(struct hwd_variable_index *index, struct hwd_variable *var) {
+    if ((index->num_vars + 1) * 2 > index->mask + 1) {
+        size_t capacity = (index->mask + 1) * 2;
+        struct hwd_variable_index_slot *slots =
+            calloc(capacity, sizeof(struct hwd_variable_index_slot));
+        if (slots == NULL) {
+            return false;
+        }
+        for (size_t i = 0; i <= index->mask; i++) {
+            if (index->slots[i].var != NULL) {
+                variable_index_insert_slot(slots, capacity - 1, index->slots[i]);
             }
         }
-        // Unescape double $ and move on
-        if (find[1] == '$') {
-            size_t length = strlen(find + 1);
-            memmove(find, find + 1, length);
-            find[length] = '\0';
-            ++find;
+        free(index->slots);
+        index->slots = slots;
+        index->mask = capacity - 1;
+    }
+
+    size_t name_length = strlen(var->name);
+    if (!variable_index_add_name_length(index, name_length)) {
+        return false;
+    }
+
+    struct hwd_variable_index_slot entry = {
+        .hash = variable_name_hash(var->name, name_length),
+        .name_length = name_length,
+        .var = var,
+    };
+    variable_index_insert_slot(index->slots, index->mask, entry);
+    index->num_vars++;
+
+    return true;
+}
+
+static struct hwd_variable_index *
+variable_index_create(list_t *symbols) {
+    struct hwd_variable_index *index = calloc(1, sizeof(struct hwd_variable_index));
+    if (index == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = 16;
+    index->mask = capacity - 1;
+    index->slots = calloc(capacity, sizeof(struct hwd_variable_index_slot));
+    if (index->slots == NULL) {
+        variable_index_destroy(index);
+        return NULL;
+    }
+
+    for (int i = 0; i < symbols->length; i++) {
+        if (!variable_index_add(index, symbols->items[i])) {
+            variable_index_destroy(index);
+            return NULL;
+        }
+    }
+
+    return index;
+}
+
+static struct hwd_variable *
+variable_index_lookup(struct hwd_variable_index *index, const char *name, size_t name_length) {
+    uint32_t hash = variable_name_hash(name, name_length);
+    size_t slot = hash & index->mask;
+    while (index->slots[slot].var != NULL) {
+        struct hwd_variable_index_slot *candidate = &index->slots[slot];
+        if (candidate->hash == hash && candidate->name_length == name_length &&
+            memcmp(candidate->var->name, name, name_length) == 0) {
+            return candidate->var;
+        }
+        slot = (slot + 1) & index->mask;
+    }
+    return NULL;
+}
+
+static struct hwd_variable *
+variable_index_find(struct hwd_variable_index *index, const char *text, size_t text_length) {
+    for (size_t i = 0; i < index->num_name_lengths; i++) {
+        size_t name_length = index->name_lengths[i];
+        if (name_length > text_length) {
             continue;
         }
-        // Find matching variable
-        for (i = 0; i < config->symbols->length; ++i) {
-            struct hwd_variable *var = config->symbols->items[i];
-            int vnlen = strlen(var->name);
-            if (strncmp(find, var->name, vnlen) == 0) {
-                int vvlen = strlen(var->value);
-                char *newstr = malloc(strlen(str) - vnlen + vvlen + 1);
-                if (!newstr) {
-                    wlr_log(
-                        WLR_ERROR,
-                        "Unable to allocate replacement "
-                        "during variable expansion"
-                    );
-                    break;
-                }
-                char *newptr = newstr;
-                int offset = find - str;
-                strncpy(newptr, str, offset);
-                newptr += offset;
-                strncpy(newptr, var->value, vvlen);
-                newptr += vvlen;
-                strcpy(newptr, find + vnlen);
-                free(str);
-                str = newstr;
-                find = str + offset + vvlen;
-                break;
-            }
+
+        struct hwd_variable *var = variable_index_lookup(index, text, name_length);
+        if (var != NULL) {
+            return var;
+        }
+    }
+    return NULL;
+}
+
+// Returns the index over the config's variables, building it if necessary, or
+// NULL if it could not be allocated.
+static struct hwd_variable_index *
+config_get_symbol_index(struct hwd_config *config) {
+    if (config->symbol_index == NULL) {
+        config->symbol_index = variable_index_create(config->symbols);
+        if (config->symbol_index == NULL) {
+            wlr_log(WLR_ERROR, "Unable to allocate variable index");
+        }
+    }
+    return config->symbol_index;
+}
+
+struct hwd_variable *
+config_get_variable(struct hwd_config *config, const char *name) {
+    struct hwd_variable_index *index = config_get_symbol_index(config);
+    if (index != NULL) {
+        return variable_index_lookup(index, name, strlen(name));
+    }
+
+    for (int i = 0; i < config->symbols->length; ++i) {
+        struct hwd_variable *var = config->symbols->items[i];
+        if (strcmp(var->name, name) == 0) {
+            return var;
+        }
+    }
+    return NULL;
+}
+
+void
+config_add_variable(struct hwd_config *config, struct hwd_variable *var) {
+    list_add(config->symbols, var);
+
+    // If the index can't be updated then drop it.  It will be rebuilt from
+    // scratch the next time it is needed.
+    if (config->symbol_index != NULL && !variable_index_add(config->symbol_index, var)) {
+        variable_index_destroy(config->symbol_index);
+        config->symbol_index = NULL;
+    }
+}
+
+struct var_replacement_buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+static bool
+var_replacement_append(struct var_replacement_buffer *buffer, const char *text, size_t length) {
+    if (buffer->length + length + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity * 2;
+        while (buffer->length + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *data = realloc(buffer->data, capacity);
+        if (data == NULL) {
+            return false;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return true;
+}
+
+char *
+do_var_replacement(char *str) {
+    char *find = strchr(str, '$');
+    if (find == NULL) {
+        return str;
+    }
+
+    struct hwd_variable_index *index = config_get_symbol_index(config);
+    if (index == NULL) {
+        return str;
+    }
+
+    size_t str_length = strlen(str);
+    const char *end = str + str_length;
+
+    struct var_replacement_buffer buffer = {
+        .data = malloc(str_length + 1),
+        .length = 0,
+        .capacity = str_length + 1,
+    };
+    if (buffer.data == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate replacement during variable expansion");
+        return str;
+    }
+
+    // The expansion is built up in a single pass.  Escapes are checked against
+    // what has been written so far, rather than the input, so that a value
+    // ending in a backslash escapes a `$` that follows it.
+    const char *cursor = str;
+    bool ok = true;
+    while (ok && find != NULL) {
+        ok = var_replacement_append(&buffer, cursor, find - cursor);
+        if (!ok) {
+            break;
         }
-        if (i == config->symbols->length) {
-            ++find;
+        cursor = find;
+
+        const char *out = buffer.data + buffer.length;
+        if (buffer.length > 0 && out[-1] == '\\' &&
+            (buffer.length == 1 || out[-2] != '\\')) {
+            // Skip if escaped.
+            ok = var_replacement_append(&buffer, "$", 1);
+            cursor += 1;
+        } else if (cursor[1] == '$') {
+            // Unescape double $ and move on.
+            ok = var_replacement_append(&buffer, "$", 1);
+            cursor += 2;
+        } else {
+            struct hwd_variable *var =
+                variable_index_find(index, cursor, end - cursor);
+            if (var != NULL) {
+                ok = var_replacement_append(&buffer, var->value, strlen(var->value));
+                cursor += strlen(var->name);
+            } else {
+                ok = var_replacement_append(&buffer, "$", 1);
+                cursor += 1;
+            }
         }
+
+        find = strchr(cursor, '$');
     }
-    return str;
+    if (ok) {
+        ok = var_replacement_append(&buffer, cursor, end - cursor);
+    }
+
+    if (!ok) {
+        wlr_log(WLR_ERROR, "Unable to allocate replacement during variable expansion");
+        free(buffer.data);
+        return str;
+    }
+
+    free(str);
+    return buffer.data;
 }
 
 void
@@ -17,9 +17,6 @@
 
 #include <hwd-workspace-management-unstable-v1-protocol.h>
 
-static void
-manager_set_dirty(struct hwd_workspace_manager_v1 *manager);
-
 static void
 workspace_handle_focus(struct wl_client *client, struct wl_resource *resource);
 
@@ -75,10 +72,21 @@ create_workspace_resource_for_resource(
     if (workspace->name != NULL) {
         hwd_workspace_handle_v1_send_name(resource, workspace->name);
     }
+    if (workspace->focused) {
+        hwd_workspace_handle_v1_send_focused(resource, true);
+    }
 
     return resource;
 }
 
+static void
+workspace_set_dirty(struct hwd_workspace_handle_v1 *workspace) {
+    if (!wl_list_empty(&workspace->dirty_link)) {
+        return;
+    }
+    wl_list_insert(workspace->manager->dirty_workspaces.prev, &workspace->dirty_link);
+}
+
 struct hwd_workspace_handle_v1 *
 hwd_workspace_handle_v1_create(struct hwd_workspace_manager_v1 *manager) {
     assert(manager != NULL);
@@ -88,20 +96,17 @@ hwd_workspace_handle_v1_create(struct hwd_workspace_manager_v1 *manager) {
         return NULL;
     }
 
-    wl_list_insert(&manager->workspaces, &workspace->link);
+    wl_list_insert(manager->workspaces.prev, &workspace->link);
     workspace->manager = manager;
 
     wl_list_init(&workspace->resources);
+    wl_list_init(&workspace->dirty_link);
 
     wl_signal_init(&workspace->events.request_focus);
     wl_signal_init(&workspace->events.destroy);
 
-    struct wl_resource *manager_resource, *tmp;
-    wl_resource_for_each_safe(manager_resource, tmp, &manager->resources) {
-        create_workspace_resource_for_resource(workspace, manager_resource);
-    }
-
-    manager_set_dirty(manager);
+    // Clients are told about the workspace on the next flush.
+    workspace_set_dirty(workspace);
 
     return workspace;
 }
@@ -119,38 +124,83 @@ hwd_workspace_handle_v1_destroy(struct hwd_workspace_handle_v1 *workspace) {
         wl_list_remove(wl_resource_get_link(resource));
         wl_list_init(wl_resource_get_link(resource));
     }
+    if (workspace->announced) {
+        workspace->manager->dirty = true;
+    }
     wl_list_remove(&workspace->link);
+    wl_list_remove(&workspace->dirty_link);
 
     free(workspace->name);
+    free(workspace->pending.name);
     free(workspace);
 }
 
 void
 hwd_workspace_handle_v1_set_name(struct hwd_workspace_handle_v1 *workspace, const char *name) {
-    workspace->name = strdup(name);
-    assert(workspace->name != NULL);
-
-    struct wl_resource *resource;
-    wl_resource_for_each(resource, &workspace->resources) {
-        hwd_workspace_handle_v1_send_name(resource, workspace->name);
+    if (workspace->pending.name != NULL && strcmp(workspace->pending.name, name) == 0) {
+        return;
     }
 
-    manager_set_dirty(workspace->manager);
+    free(workspace->pending.name);
+    workspace->pending.name = strdup(name);
+    assert(workspace->pending.name != NULL);
+
+    workspace_set_dirty(workspace);
 }
 
 void
 hwd_workspace_handle_v1_set_focused(struct hwd_workspace_handle_v1 *workspace, bool focused) {
-    if (focused == workspace->focused) {
+    if (focused == workspace->pending.focused) {
         return;
     }
-    workspace->focused = focused;
+    workspace->pending.focused = focused;
+
+    workspace_set_dirty(workspace);
+}
+
+static bool
+workspace_flush(struct hwd_workspace_handle_v1 *workspace) {
+    struct hwd_workspace_manager_v1 *manager = workspace->manager;
+
+    if (!workspace->announced) {
+        workspace->announced = true;
+
+        free(workspace->name);
+        workspace->name = workspace->pending.name ? strdup(workspace->pending.name) : NULL;
+        workspace->focused = workspace->pending.focused;
 
+        struct wl_resource *manager_resource, *tmp;
+        wl_resource_for_each_safe(manager_resource, tmp, &manager->resources) {
+            create_workspace_resource_for_resource(workspace, manager_resource);
+        }
+        return true;
+    }
+
+    bool changed = false;
     struct wl_resource *resource;
-    wl_resource_for_each(resource, &workspace->resources) {
-        hwd_workspace_handle_v1_send_focused(resource, focused);
+
+    if (workspace->pending.name != NULL &&
+        (workspace->name == NULL || strcmp(workspace->name, workspace->pending.name) != 0)) {
+        free(workspace->name);
+        workspace->name = strdup(workspace->pending.name);
+        assert(workspace->name != NULL);
+
+        wl_resource_for_each(resource, &workspace->resources) {
+            hwd_workspace_handle_v1_send_name(resource, workspace->name);
+        }
+        changed = true;
     }
 
-    manager_set_dirty(workspace->manager);
+    if (workspace->pending.focused != workspace->focused) {
+        workspace->focused = workspace->pending.focused;
+
+        wl_resource_for_each(resource, &workspace->resources) {
+            hwd_workspace_handle_v1_send_focused(resource, workspace->focused);
+        }
+        changed = true;
+    }
+
+    return changed;
 }
 
 static void
@@ -190,33 +240,18 @@ manager_handle_bind(struct wl_client *client, void *data, uint32_t version, uint
 
     wl_list_insert(&manager->resources, wl_resource_get_link(resource));
 
+    // Workspaces that haven't been announced yet will be sent, along with any
+    // other pending changes, on the next flush.
     struct hwd_workspace_handle_v1 *workspace, *tmp;
     wl_list_for_each_safe(workspace, tmp, &manager->workspaces, link) {
-        create_workspace_resource_for_resource(workspace, resource);
+        if (workspace->announced) {
+            create_workspace_resource_for_resource(workspace, resource);
+        }
     }
 
     hwd_workspace_manager_v1_send_done(resource);
 }
 
-static void
-manager_idle_send_done(void *data) {
-    struct hwd_workspace_manager_v1 *manager = data;
-    struct wl_resource *resource;
-    wl_resource_for_each(resource, &manager->resources) {
-        hwd_workspace_manager_v1_send_done(resource);
-    }
-    manager->idle_source = NULL;
-}
-
-static void
-manager_set_dirty(struct hwd_workspace_manager_v1 *manager) {
-    if (manager->idle_source != NULL) {
-        return;
-    }
-    manager->idle_source =
-        wl_event_loop_add_idle(manager->event_loop, manager_idle_send_done, manager);
-}
-
 struct hwd_workspace_manager_v1 *
 hwd_workspace_manager_v1_create(struct wl_display *display) {
     struct hwd_workspace_manager_v1 *manager = calloc(1, sizeof(struct hwd_workspace_manager_v1));
@@ -224,7 +259,6 @@ hwd_workspace_manager_v1_create(struct wl_display *display) {
         return NULL;
     }
 
-    manager->event_loop = wl_display_get_event_loop(display);
     manager->global = wl_global_create(
         display, &hwd_workspace_manager_v1_interface, 1, manager, manager_handle_bind
     );
@@ -236,6 +270,33 @@ hwd_workspace_manager_v1_create(struct wl_display *display) {
     wl_signal_init(&manager->events.destroy);
     wl_list_init(&manager->resources);
     wl_list_init(&manager->workspaces);
+    wl_list_init(&manager->dirty_workspaces);
 
     return manager;
 }
+
+void
+hwd_workspace_manager_v1_flush(struct hwd_workspace_manager_v1 *manager) {
+    bool changed = manager->dirty;
+    manager->dirty = false;
+
+    while (!wl_list_empty(&manager->dirty_workspaces)) {
+        struct hwd_workspace_handle_v1 *workspace =
+            wl_container_of(manager->dirty_workspaces.next, workspace, dirty_link);
+        wl_list_remove(&workspace->dirty_link);
+        wl_list_init(&workspace->dirty_link);
+
+        if (workspace_flush(workspace)) {
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    struct wl_resource *resource;
+    wl_resource_for_each(resource, &manager->resources) {
+        hwd_workspace_manager_v1_send_done(resource);
+    }
+}
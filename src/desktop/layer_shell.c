@@ -32,9 +32,15 @@
 #include <hayward/list.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
+#include <hayward/tree/workspace.h>
 
 #define HWD_LAYER_SHELL_VERSION 4
 
+#define HWD_LAYER_SURFACE_PLACEMENT_STATE                                                          \
+    (WLR_LAYER_SURFACE_V1_STATE_DESIRED_SIZE | WLR_LAYER_SURFACE_V1_STATE_ANCHOR |                 \
+     WLR_LAYER_SURFACE_V1_STATE_EXCLUSIVE_ZONE | WLR_LAYER_SURFACE_V1_STATE_MARGIN |               \
+     WLR_LAYER_SURFACE_V1_STATE_LAYER)
+
 static void
 surface_scene_marker_destroy(struct wlr_addon *addon) {
     // Intentionally left blank.
@@ -69,6 +75,7 @@ arrange_layers(struct hwd_output *output) {
     struct wlr_box usable_area = {0};
     wlr_output_effective_resolution(output->wlr_output, &usable_area.width, &usable_area.height);
     const struct wlr_box full_area = usable_area;
+    output->layers_area = full_area;
 
     arrange_surface(output, &full_area, &usable_area, output->layers.shell_background);
     arrange_surface(output, &full_area, &usable_area, output->layers.shell_bottom);
@@ -79,9 +86,31 @@ arrange_layers(struct hwd_output *output) {
         wlr_log(WLR_DEBUG, "Usable area changed, rearranging output");
         output->usable_area = usable_area;
         output_set_dirty(output);
+
+        // Tiling is laid out within the usable area, so workspaces only need
+        // to be rearranged when it changes.
+        if (root->active_workspace != NULL) {
+            workspace_set_dirty(root->active_workspace);
+        }
+        root->hidden_workspaces_dirty = true;
     }
 }
 
+static bool
+layer_surface_placement_changed(struct hwd_layer_surface *layer_surface) {
+    const struct wlr_layer_surface_v1_state *current = &layer_surface->layer_surface->current;
+    const struct wlr_layer_surface_v1_state *arranged = &layer_surface->arranged;
+
+    return current->layer != arranged->layer || current->anchor != arranged->anchor ||
+        current->exclusive_zone != arranged->exclusive_zone ||
+        current->margin.top != arranged->margin.top ||
+        current->margin.right != arranged->margin.right ||
+        current->margin.bottom != arranged->margin.bottom ||
+        current->margin.left != arranged->margin.left ||
+        current->desired_width != arranged->desired_width ||
+        current->desired_height != arranged->desired_height;
+}
+
 static struct wlr_scene_tree *
 hwd_layer_get_scene(struct hwd_output *output, enum zwlr_layer_shell_v1_layer type) {
     switch (type) {
@@ -197,8 +226,18 @@ handle_surface_commit(struct wl_listener *listener, void *data) {
         wlr_scene_node_reparent(&layer_surface->scene->tree->node, output_layer);
     }
 
-    if (committed || wlr_layer_surface->surface->mapped != layer_surface->mapped) {
+    // Clients such as bars commit frequently, and often re-send their size
+    // and anchors along with each update.  The output is only rearranged if
+    // something that affects placement actually changed.
+    bool rearrange = wlr_layer_surface->initial_commit ||
+        wlr_layer_surface->surface->mapped != layer_surface->mapped;
+    if (committed & HWD_LAYER_SURFACE_PLACEMENT_STATE) {
+        rearrange = rearrange || layer_surface_placement_changed(layer_surface);
+    }
+
+    if (rearrange) {
         layer_surface->mapped = wlr_layer_surface->surface->mapped;
+        layer_surface->arranged = wlr_layer_surface->current;
         arrange_layers(layer_surface->output);
     }
 
@@ -218,7 +257,6 @@ handle_map(struct wl_listener *listener, void *data) {
         (wlr_layer_surface->current.layer == ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY ||
          wlr_layer_surface->current.layer == ZWLR_LAYER_SHELL_V1_LAYER_TOP)) {
         root_set_focused_layer(root, wlr_layer_surface);
-        arrange_layers(layer_surface->output);
         root_commit_focus(root);
     }
 }
@@ -7,17 +7,26 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 #include <wayland-server-core.h>
 #include <wayland-util.h>
 
+#include <wlr/backend.h>
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_output_management_v1.h>
+#include <wlr/types/wlr_output_swapchain_manager.h>
+#include <wlr/types/wlr_scene.h>
 #include <wlr/util/box.h>
 #include <wlr/util/log.h>
 
+#include <hayward/globals/root.h>
+#include <hayward/profiler.h>
+#include <hayward/server.h>
+#include <hayward/tree/root.h>
+
 static void
 output_manager_update_config(struct hwd_wlr_output_manager_v1 *manager) {
     struct wlr_output_configuration_v1 *config = wlr_output_configuration_v1_create();
@@ -40,81 +49,100 @@ output_manager_update_config(struct hwd_wlr_output_manager_v1 *manager) {
     wlr_output_manager_v1_set_configuration(manager->wlr_manager, config);
 }
 
-static void
-output_manager_apply(
-    struct hwd_wlr_output_manager_v1 *manager, struct wlr_output_configuration_v1 *config,
-    bool test_only
+static bool
+output_manager_build_buffers(
+    struct wlr_output_swapchain_manager *swapchain_manager, struct wlr_backend_output_state *states,
+    size_t states_len
 ) {
-    bool ok = true;
+    for (size_t i = 0; i < states_len; i++) {
+        struct wlr_output *wlr_output = states[i].output;
+        struct wlr_output_state *state = &states[i].base;
 
-    // Disable outputs first to conserve CRTs.
-    struct wlr_output_configuration_head_v1 *config_head;
-    wl_list_for_each(config_head, &config->heads, link) {
-        struct wlr_output *wlr_output = config_head->state.output;
-        if (config_head->state.enabled) {
+        if (!(state->committed & WLR_OUTPUT_STATE_ENABLED) || !state->enabled) {
             continue;
         }
 
-        struct wlr_output_state new_state;
-        wlr_output_state_init(&new_state);
-
-        wlr_output_state_set_enabled(&new_state, false);
-
-        if (test_only) {
-            if (!wlr_output_test_state(wlr_output, &new_state)) {
-                ok = false;
-            }
-        } else {
-            if (!wlr_output_commit_state(wlr_output, &new_state)) {
-                wlr_log(WLR_ERROR, "Failed to commit output %s", wlr_output->name);
-                ok = false;
-            }
+        struct wlr_scene_output *scene_output =
+            wlr_scene_get_scene_output(root->root_scene, wlr_output);
+        if (scene_output == NULL) {
+            wlr_log(WLR_ERROR, "No scene output for %s", wlr_output->name);
+            return false;
         }
 
-        wlr_output_state_finish(&new_state);
-    }
-
-    // Then enable outputs that need to
-    wl_list_for_each(config_head, &config->heads, link) {
-        struct wlr_output *wlr_output = config_head->state.output;
-
-        if (!config_head->state.enabled) {
-            continue;
+        struct wlr_scene_output_state_options options = {
+            .swapchain =
+                wlr_output_swapchain_manager_get_swapchain(swapchain_manager, wlr_output),
+        };
+        if (!wlr_scene_output_build_state(scene_output, state, &options)) {
+            wlr_log(WLR_ERROR, "Failed to render new frame for %s", wlr_output->name);
+            return false;
         }
+    }
 
-        struct wlr_output_state new_state;
-        wlr_output_state_init(&new_state);
+    return true;
+}
 
-        wlr_output_state_set_enabled(&new_state, true);
+static void
+output_manager_apply(
+    struct hwd_wlr_output_manager_v1 *manager, struct wlr_output_configuration_v1 *config,
+    bool test_only
+) {
+    HWD_PROFILER_TRACE();
+
+    // All heads are tested and committed together so that rearranging several
+    // outputs results in a single modeset rather than one per output.
+    size_t states_len = 0;
+    struct wlr_backend_output_state *states =
+        wlr_output_configuration_v1_build_state(config, &states_len);
+    if (states == NULL) {
+        wlr_log(WLR_ERROR, "Failed to build output state for configuration");
+        wlr_output_configuration_v1_send_failed(config);
+        wlr_output_configuration_v1_destroy(config);
+        return;
+    }
 
-        if (config_head->state.mode != NULL) {
-            wlr_output_state_set_mode(&new_state, config_head->state.mode);
-        } else {
-            wlr_output_state_set_custom_mode(
-                &new_state, config_head->state.custom_mode.width,
-                config_head->state.custom_mode.height, config_head->state.custom_mode.refresh
-            );
-        }
+    // Make sure buffers can be allocated for every enabled output at once.
+    // Without this an output can be left with a swapchain that only worked
+    // while some other output was off.
+    struct wlr_output_swapchain_manager swapchain_manager;
+    wlr_output_swapchain_manager_init(&swapchain_manager, server.backend);
 
-        wlr_output_state_set_transform(&new_state, config_head->state.transform);
-        wlr_output_state_set_scale(&new_state, config_head->state.scale);
+    bool ok = wlr_output_swapchain_manager_prepare(&swapchain_manager, states, states_len) &&
+        output_manager_build_buffers(&swapchain_manager, states, states_len);
 
+    if (ok) {
         if (test_only) {
-            if (!wlr_output_test_state(wlr_output, &new_state)) {
-                ok = false;
-            }
+            ok = wlr_backend_test(server.backend, states, states_len);
         } else {
-            if (!wlr_output_commit_state(wlr_output, &new_state)) {
-                wlr_log(WLR_ERROR, "Failed to commit output %s", wlr_output->name);
-                ok = false;
+            ok = wlr_backend_commit(server.backend, states, states_len);
+            if (ok) {
+                wlr_output_swapchain_manager_apply(&swapchain_manager);
+            } else {
+                wlr_log(WLR_ERROR, "Failed to commit output configuration");
             }
         }
+    }
 
-        wlr_output_state_finish(&new_state);
+    wlr_output_swapchain_manager_finish(&swapchain_manager);
 
-        wlr_output_layout_add(
-            manager->output_layout, wlr_output, config_head->state.x, config_head->state.y
-        );
+    for (size_t i = 0; i < states_len; i++) {
+        wlr_output_state_finish(&states[i].base);
+    }
+    free(states);
+
+    if (ok && !test_only) {
+        // Layout changes only mark the root as dirty, so all of these are
+        // picked up by a single arrange in the next transaction.
+        struct wlr_output_configuration_head_v1 *config_head;
+        wl_list_for_each(config_head, &config->heads, link) {
+            if (!config_head->state.enabled) {
+                continue;
+            }
+            wlr_output_layout_add(
+                manager->output_layout, config_head->state.output, config_head->state.x,
+                config_head->state.y
+            );
+        }
     }
 
     if (ok) {
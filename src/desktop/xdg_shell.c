@@ -28,10 +28,12 @@
 
 #include <xdg-shell-protocol.h>
 
+#include <hayward/config.h>
 #include <hayward/globals/root.h>
 #include <hayward/input/seat.h>
 #include <hayward/input/seatop_move.h>
 #include <hayward/input/seatop_resize_floating.h>
+#include <hayward/server.h>
 #include <hayward/tree/column.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
@@ -39,7 +41,11 @@
 #include <hayward/tree/window.h>
 #include <hayward/tree/workspace.h>
 
-#define HWD_XDG_SHELL_VERSION 5
+#define HWD_XDG_SHELL_VERSION 6
+
+// Time a toplevel must stay hidden before it is told that it is suspended.
+// Avoids flapping when quickly switching back and forth between workspaces.
+#define HWD_XDG_SHELL_SUSPEND_DELAY_MS 1000
 
 static struct hwd_xdg_popup *
 hwd_xdg_popup_create(struct wlr_xdg_popup *wlr_popup, struct hwd_xdg_shell_view *xdg_shell_view);
@@ -177,17 +183,80 @@ xdg_shell_view_from_view(struct hwd_view *view) {
     return (struct hwd_xdg_shell_view *)view;
 }
 
+static bool
+xdg_shell_view_is_visible(struct hwd_xdg_shell_view *self) {
+    struct hwd_window *window = self->window;
+
+    return window_is_visible(window) && workspace_is_visible(window->workspace);
+}
+
+static int
+hwd_xdg_shell_view_handle_suspend_timeout(void *data) {
+    struct hwd_xdg_shell_view *self = data;
+    struct hwd_window *window = self->window;
+
+    self->suspend_pending = false;
+
+    if (self->configured_is_suspended || xdg_shell_view_is_visible(self)) {
+        return 0;
+    }
+
+    if (window->is_configuring) {
+        // Sending a new configure would prevent the client from acking the
+        // one the current transaction is waiting for.  Try again later.
+        self->suspend_pending = true;
+        wl_event_source_timer_update(self->suspend_timer, HWD_XDG_SHELL_SUSPEND_DELAY_MS);
+        return 0;
+    }
+
+    self->configured_is_suspended = true;
+    wlr_xdg_toplevel_set_suspended(self->wlr_xdg_toplevel, true);
+
+    return 0;
+}
+
 static void
 hwd_xdg_shell_view_handle_window_commit(struct wl_listener *listener, void *data) {
     struct hwd_xdg_shell_view *self = wl_container_of(listener, self, window_commit);
     struct hwd_window *window = self->window;
 
-    if (!window_is_visible(window)) {
+    if (!xdg_shell_view_is_visible(self)) {
+        if (!self->configured_is_suspended && !self->suspend_pending) {
+            self->suspend_pending = true;
+            wl_event_source_timer_update(self->suspend_timer, HWD_XDG_SHELL_SUSPEND_DELAY_MS);
+        }
+
+        if (window_is_visible(window)) {
+            // The window is on an inactive workspace that is being arranged
+            // in the background.  Let the client resize ahead of time so that
+            // switching to the workspace does not need to wait for it.
+            double width = window->pending.content_width;
+            double height = window->pending.content_height;
+            if (width != self->configured_width || height != self->configured_height) {
+                self->configured_width = width;
+                self->configured_height = height;
+
+                wlr_xdg_toplevel_set_size(self->wlr_xdg_toplevel, width, height);
+            }
+        }
         return;
     }
 
     bool dirty = false;
 
+    if (self->suspend_pending) {
+        self->suspend_pending = false;
+        wl_event_source_timer_update(self->suspend_timer, 0);
+    }
+
+    // Resuming does not by itself change what the window should look like,
+    // so there is no need to hold the transaction for it.
+    if (self->configured_is_suspended) {
+        self->configured_is_suspended = false;
+
+        wlr_xdg_toplevel_set_suspended(self->wlr_xdg_toplevel, false);
+    }
+
     if (self->force_reconfigure) {
         self->force_reconfigure = false;
         dirty = true;
@@ -322,6 +391,69 @@ send_frame_done_iterator(struct wlr_scene_buffer *scene_buffer, int x, int y, vo
     wl_signal_emit_mutable(&scene_buffer->events.frame_done, when);
 }
 
+static void
+xdg_shell_view_send_frame_done(struct hwd_xdg_shell_view *self, struct timespec *when) {
+    struct wlr_scene_node *node;
+    wl_list_for_each(node, &self->scene_tree->children, link) {
+        wlr_scene_node_for_each_buffer(node, send_frame_done_iterator, when);
+    }
+}
+
+static void
+find_output_iterator(struct wlr_scene_buffer *scene_buffer, int x, int y, void *data) {
+    bool *on_output = data;
+    if (scene_buffer->primary_output != NULL) {
+        *on_output = true;
+    }
+}
+
+// Returns true if none of the view's buffers can be seen on any output, for
+// example because the window is fully covered by others.  The scene leaves
+// occluded buffers without a primary output.
+static bool
+xdg_shell_view_is_occluded(struct hwd_xdg_shell_view *self) {
+    bool on_output = false;
+    struct wlr_scene_node *node;
+    wl_list_for_each(node, &self->scene_tree->children, link) {
+        wlr_scene_node_for_each_buffer(node, find_output_iterator, &on_output);
+    }
+    return !on_output;
+}
+
+static int
+hwd_xdg_shell_handle_hidden_frame_timeout(void *data) {
+    struct hwd_xdg_shell *self = data;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    struct hwd_xdg_shell_view *view, *tmp;
+    wl_list_for_each_safe(view, tmp, &self->hidden_frame_views, hidden_frame_link) {
+        wl_list_remove(&view->hidden_frame_link);
+        wl_list_init(&view->hidden_frame_link);
+
+        xdg_shell_view_send_frame_done(view, &now);
+    }
+
+    return 0;
+}
+
+static void
+xdg_shell_view_schedule_hidden_frame_done(struct hwd_xdg_shell_view *self) {
+    struct hwd_xdg_shell *xdg_shell = self->xdg_shell;
+
+    if (!wl_list_empty(&self->hidden_frame_link)) {
+        return;
+    }
+
+    if (wl_list_empty(&xdg_shell->hidden_frame_views)) {
+        int delay = 1000 / config->hidden_frame_rate;
+        wl_event_source_timer_update(xdg_shell->hidden_frame_timer, delay > 0 ? delay : 1);
+    }
+
+    wl_list_insert(xdg_shell->hidden_frame_views.prev, &self->hidden_frame_link);
+}
+
 static void
 xdg_shell_view_handle_wlr_surface_commit(struct wl_listener *listener, void *data) {
     struct hwd_xdg_shell_view *self = wl_container_of(listener, self, wlr_surface_commit);
@@ -369,12 +501,17 @@ xdg_shell_view_handle_wlr_surface_commit(struct wl_listener *listener, void *dat
 
     // TODO don't send if transaction is in progress.
     if (!success) {
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (xdg_shell_view_is_visible(self) && !xdg_shell_view_is_occluded(self)) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
 
-        struct wlr_scene_node *node;
-        wl_list_for_each(node, &self->scene_tree->children, link) {
-            wlr_scene_node_for_each_buffer(node, send_frame_done_iterator, &now);
+            xdg_shell_view_send_frame_done(self, &now);
+        } else {
+            // Hidden and fully covered windows are not drawn, so there is no
+            // point letting them redraw any faster than is needed to keep them
+            // responsive.  Once uncovered they are sent frame done by the
+            // scheduler again.
+            xdg_shell_view_schedule_hidden_frame_done(self);
         }
     }
 }
@@ -512,6 +649,14 @@ hwd_xdg_shell_view_handle_wlr_surface_unmap(struct wl_listener *listener, void *
 
     view->surface = NULL;
 
+    wl_event_source_remove(self->suspend_timer);
+    self->suspend_timer = NULL;
+    self->suspend_pending = false;
+    self->configured_is_suspended = false;
+
+    wl_list_remove(&self->hidden_frame_link);
+    wl_list_init(&self->hidden_frame_link);
+
     wl_list_remove(&self->root_focus_changed.link);
     wl_list_remove(&self->window_close.link);
     wl_list_remove(&self->window_commit.link);
@@ -582,6 +727,11 @@ hwd_xdg_shell_view_handle_wlr_surface_map(struct wl_listener *listener, void *da
     self->window_commit.notify = hwd_xdg_shell_view_handle_window_commit;
     wl_signal_add(&self->window->events.commit, &self->window_commit);
 
+    self->suspend_timer = wl_event_loop_add_timer(
+        server.wl_event_loop, hwd_xdg_shell_view_handle_suspend_timeout, self
+    );
+    assert(self->suspend_timer != NULL);
+
     self->window_close.notify = hwd_xdg_shell_view_handle_window_close;
     wl_signal_add(&self->window->events.close, &self->window_close);
 
@@ -705,6 +855,8 @@ hwd_xdg_shell_handle_new_toplevel(struct wl_listener *listener, void *data) {
 
     xdg_shell_view->xdg_shell = self;
 
+    wl_list_init(&xdg_shell_view->hidden_frame_link);
+
     xdg_shell_view->scene_tree = wlr_scene_xdg_surface_create(NULL, xdg_surface);
 
     view_init(&xdg_shell_view->view, HWD_VIEW_XDG_SHELL, &view_impl);
@@ -738,6 +890,15 @@ hwd_xdg_shell_create(struct wl_display *wl_display) {
         return NULL;
     }
 
+    wl_list_init(&xdg_shell->hidden_frame_views);
+    xdg_shell->hidden_frame_timer = wl_event_loop_add_timer(
+        server.wl_event_loop, hwd_xdg_shell_handle_hidden_frame_timeout, xdg_shell
+    );
+    if (xdg_shell->hidden_frame_timer == NULL) {
+        free(xdg_shell);
+        return NULL;
+    }
+
     xdg_shell->new_toplevel.notify = hwd_xdg_shell_handle_new_toplevel;
     wl_signal_add(&xdg_shell->xdg_shell->events.new_toplevel, &xdg_shell->new_toplevel);
 
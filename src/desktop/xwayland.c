@@ -31,9 +31,11 @@
 #include <hayward/input/seat.h>
 #include <hayward/input/seatop_move.h>
 #include <hayward/input/seatop_resize_floating.h>
+#include <hayward/input/xcursor_theme.h>
 #include <hayward/tree/column.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
 #include <hayward/tree/view.h>
 #include <hayward/tree/window.h>
 #include <hayward/tree/workspace.h>
@@ -247,6 +249,56 @@ hwd_xwayland_view_from_view(struct hwd_view *view) {
     return (struct hwd_xwayland_view *)view;
 }
 
+static void
+hwd_xwayland_view_queue_move(struct hwd_xwayland_view *self) {
+    struct hwd_xwayland *xwayland = self->xwayland;
+
+    if (!wl_list_empty(&self->pending_move_link)) {
+        return;
+    }
+
+    if (wl_list_empty(&xwayland->pending_moves)) {
+        struct hwd_transaction_manager *transaction_manager = root_get_transaction_manager(root);
+        wl_signal_add(&transaction_manager->events.apply, &xwayland->transaction_apply);
+    }
+
+    wl_list_insert(xwayland->pending_moves.prev, &self->pending_move_link);
+}
+
+static void
+hwd_xwayland_view_cancel_move(struct hwd_xwayland_view *self) {
+    struct hwd_xwayland *xwayland = self->xwayland;
+
+    if (wl_list_empty(&self->pending_move_link)) {
+        return;
+    }
+
+    wl_list_remove(&self->pending_move_link);
+    wl_list_init(&self->pending_move_link);
+
+    if (wl_list_empty(&xwayland->pending_moves)) {
+        wl_list_remove(&xwayland->transaction_apply.link);
+    }
+}
+
+static void
+hwd_xwayland_handle_transaction_apply(struct wl_listener *listener, void *data) {
+    struct hwd_xwayland *self = wl_container_of(listener, self, transaction_apply);
+
+    wl_list_remove(&self->transaction_apply.link);
+
+    struct hwd_xwayland_view *view, *tmp;
+    wl_list_for_each_safe(view, tmp, &self->pending_moves, pending_move_link) {
+        wl_list_remove(&view->pending_move_link);
+        wl_list_init(&view->pending_move_link);
+
+        wlr_xwayland_surface_configure(
+            view->wlr_xwayland_surface, view->configured_x, view->configured_y,
+            view->configured_width, view->configured_height
+        );
+    }
+}
+
 static void
 hwd_xwayland_view_handle_window_commit(struct wl_listener *listener, void *data) {
     struct hwd_xwayland_view *self = wl_container_of(listener, self, window_commit);
@@ -281,20 +333,29 @@ hwd_xwayland_view_handle_window_commit(struct wl_listener *listener, void *data)
     int y = (int)window->pending.content_y;
     int width = (int)window->pending.content_width;
     int height = (int)window->pending.content_height;
-    if (x != self->configured_x || y != self->configured_y || width != self->configured_width ||
-        height != self->configured_height) {
-        self->configured_x = x;
-        self->configured_y = y;
-        self->configured_width = width;
-        self->configured_height = height;
+    bool moved = x != self->configured_x || y != self->configured_y;
+    bool resized = width != self->configured_width || height != self->configured_height;
 
-        wlr_xwayland_surface_configure(xsurface, x, y, width, height);
+    self->configured_x = x;
+    self->configured_y = y;
+    self->configured_width = width;
+    self->configured_height = height;
 
+    if (resized) {
         dirty = true;
     }
 
     if (dirty) {
+        if (moved || resized) {
+            hwd_xwayland_view_cancel_move(self);
+            wlr_xwayland_surface_configure(xsurface, x, y, width, height);
+        }
         window_begin_configure(self->window);
+    } else if (moved) {
+        // X11 clients do not need to redraw when moved, so there is nothing
+        // to wait for.  Tell them about their new position once the move is
+        // visible.
+        hwd_xwayland_view_queue_move(self);
     }
 }
 
@@ -508,6 +569,8 @@ hwd_xwayland_view_handle_unmap(struct wl_listener *listener, void *data) {
 
     view->surface = NULL;
 
+    hwd_xwayland_view_cancel_move(self);
+
     wl_list_remove(&self->xsurface_commit.link);
     wl_list_remove(&self->window_commit.link);
     wl_list_remove(&self->window_close.link);
@@ -848,6 +911,8 @@ create_xwayland_view(struct hwd_xwayland *xwayland, struct wlr_xwayland_surface
     self->wlr_xwayland_surface = xsurface;
     self->xwayland = xwayland;
 
+    wl_list_init(&self->pending_move_link);
+
     wl_signal_add(&xsurface->events.destroy, &self->xsurface_destroy);
     self->xsurface_destroy.notify = hwd_xwayland_view_handle_destroy;
 
@@ -965,6 +1030,9 @@ hwd_xwayland_create(struct wl_display *wl_display, struct wlr_compositor *compos
         unsetenv("DISPLAY");
         return NULL;
     } else {
+        wl_list_init(&self->pending_moves);
+        self->transaction_apply.notify = hwd_xwayland_handle_transaction_apply;
+
         self->new_surface.notify = hwd_xwayland_handle_new_surface;
         wl_signal_add(&self->xwayland->events.new_surface, &self->new_surface);
 
@@ -980,6 +1048,10 @@ hwd_xwayland_create(struct wl_display *wl_display, struct wlr_compositor *compos
 
 void
 hwd_xwayland_destroy(struct hwd_xwayland *self) {
+    if (!wl_list_empty(&self->pending_moves)) {
+        wl_list_remove(&self->transaction_apply.link);
+    }
+    hwd_xcursor_theme_release(self->xcursor_manager);
     wlr_xwayland_destroy(self->xwayland);
     free(self);
 }
@@ -26,6 +26,7 @@
 
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_cursor.h>
+#include <wlr/types/wlr_cursor_shape_v1.h>
 #include <wlr/types/wlr_input_device.h>
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_output_layout.h>
@@ -52,6 +53,8 @@
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
 #include <hayward/input/tablet.h>
+#include <hayward/input/xcursor_theme.h>
+#include <hayward/latency.h>
 #include <hayward/server.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
@@ -275,6 +278,8 @@ cursor_handle_activity_from_idle_source(
 
 void
 cursor_handle_activity_from_device(struct hwd_cursor *cursor, struct wlr_input_device *device) {
+    hwd_latency_notify_input();
+
     enum hwd_input_idle_source idle_source = idle_source_from_device(device);
     cursor_handle_activity_from_idle_source(cursor, idle_source);
 }
@@ -1122,7 +1127,7 @@ hwd_cursor_destroy(struct hwd_cursor *cursor) {
     wl_list_remove(&cursor->request_set_cursor.link);
     wl_list_remove(&cursor->root_scene_changed.link);
 
-    wlr_xcursor_manager_destroy(cursor->xcursor_manager);
+    hwd_xcursor_theme_release(cursor->xcursor_manager);
     wlr_cursor_destroy(cursor->cursor);
     free(cursor);
 }
@@ -1357,6 +1362,36 @@ handle_pointer_constraint(struct wl_listener *listener, void *data) {
     }
 }
 
+void
+handle_request_set_cursor_shape(struct wl_listener *listener, void *data) {
+    struct wlr_cursor_shape_manager_v1_request_set_shape_event *event = data;
+    struct hwd_seat *seat = event->seat_client->seat->data;
+
+    // Tablet tools are not yet given their own cursors.
+    if (event->device_type != WLR_CURSOR_SHAPE_MANAGER_V1_DEVICE_TYPE_POINTER) {
+        return;
+    }
+
+    if (!seatop_allows_set_cursor(seat)) {
+        return;
+    }
+
+    struct wl_client *focused_client = NULL;
+    struct wlr_surface *focused_surface = seat->wlr_seat->pointer_state.focused_surface;
+    if (focused_surface != NULL) {
+        focused_client = wl_resource_get_client(focused_surface->resource);
+    }
+
+    if (focused_client == NULL || event->seat_client->client != focused_client) {
+        wlr_log(WLR_DEBUG, "denying request to set cursor shape from unfocused client");
+        return;
+    }
+
+    // Shape names are static strings, so can be held by the cursor, and are
+    // drawn from the same shared theme as the compositor's own cursors.
+    cursor_set_image(seat->cursor, wlr_cursor_shape_v1_name(event->shape), focused_client);
+}
+
 void
 hwd_cursor_constrain(struct hwd_cursor *cursor, struct wlr_pointer_constraint_v1 *constraint) {
     struct seat_config *config = seat_get_config(cursor->seat);
@@ -41,6 +41,7 @@
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
 #include <hayward/input/text_input.h>
+#include <hayward/latency.h>
 #include <hayward/list.h>
 #include <hayward/server.h>
 
@@ -476,6 +477,8 @@ keyboard_get_im_grab(struct hwd_keyboard *keyboard) {
 
 static void
 handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *event) {
+    hwd_latency_notify_input();
+
     struct hwd_seat *seat = keyboard->seat_device->hwd_seat;
     struct wlr_seat *wlr_seat = seat->wlr_seat;
     struct wlr_input_device *wlr_device = keyboard->seat_device->input_device->wlr_device;
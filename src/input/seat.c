@@ -50,11 +50,13 @@
 #include <hayward/input/switch.h>
 #include <hayward/input/tablet.h>
 #include <hayward/input/text_input.h>
+#include <hayward/input/xcursor_theme.h>
 #include <hayward/list.h>
 #include <hayward/server.h>
 #include <hayward/tree/drag_icon.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
 #include <hayward/tree/view.h>
 #include <hayward/tree/window.h>
 
@@ -73,6 +75,14 @@ static void
 handle_request_set_primary_selection(struct wl_listener *listener, void *data);
 static void
 handle_root_focus_changed(struct wl_listener *listener, void *data);
+static void
+handle_seatop_motion_output_frame(struct wl_listener *listener, void *data);
+static void
+handle_seatop_motion_output_destroy(struct wl_listener *listener, void *data);
+static void
+handle_seatop_motion_transaction_after_apply(struct wl_listener *listener, void *data);
+static void
+seatop_motion_cancel(struct hwd_seat *seat);
 
 struct hwd_seat *
 seat_create(const char *seat_name) {
@@ -124,6 +134,11 @@ seat_create(const char *seat_name) {
     seat->root_focus_changed.notify = handle_root_focus_changed;
     wl_signal_add(&root->events.focus_changed, &seat->root_focus_changed);
 
+    seat->seatop_motion.output_frame.notify = handle_seatop_motion_output_frame;
+    seat->seatop_motion.output_destroy.notify = handle_seatop_motion_output_destroy;
+    seat->seatop_motion.transaction_after_apply.notify =
+        handle_seatop_motion_transaction_after_apply;
+
     seatop_begin_default(seat);
 
     return seat;
@@ -156,6 +171,8 @@ seat_destroy(struct hwd_seat *seat) {
         seat_device_destroy(seat_device);
     }
 
+    seatop_motion_cancel(seat);
+
     hwd_input_method_relay_finish(&seat->im_relay);
     hwd_cursor_destroy(seat->cursor);
     wl_list_remove(&seat->request_start_drag.link);
@@ -698,11 +715,6 @@ seat_remove_device(struct hwd_seat *seat, struct hwd_input_device *input_device)
     seat_update_capabilities(seat);
 }
 
-static bool
-xcursor_manager_is_named(const struct wlr_xcursor_manager *manager, const char *name) {
-    return (!manager->name && !name) || (name && manager->name && strcmp(name, manager->name) == 0);
-}
-
 void
 seat_configure_xcursor(struct hwd_seat *seat) {
     unsigned cursor_size = 24;
@@ -726,57 +738,45 @@ seat_configure_xcursor(struct hwd_seat *seat) {
         }
 
 #if HAVE_XWAYLAND
-        if (server.xwayland != NULL &&
-            (!server.xwayland->xcursor_manager ||
-             !xcursor_manager_is_named(server.xwayland->xcursor_manager, cursor_theme) ||
-             server.xwayland->xcursor_manager->size != cursor_size)) {
-
-            wlr_xcursor_manager_destroy(server.xwayland->xcursor_manager);
-
-            server.xwayland->xcursor_manager =
-                wlr_xcursor_manager_create(cursor_theme, cursor_size);
-            assert(server.xwayland->xcursor_manager);
-
-            wlr_xcursor_manager_load(server.xwayland->xcursor_manager, 1);
-            struct wlr_xcursor *xcursor =
-                wlr_xcursor_manager_get_xcursor(server.xwayland->xcursor_manager, "left_ptr", 1);
-            if (xcursor != NULL) {
-                struct wlr_xcursor_image *image = xcursor->images[0];
-                wlr_xwayland_set_cursor(
-                    server.xwayland->xwayland, image->buffer, image->width * 4, image->width,
-                    image->height, image->hotspot_x, image->hotspot_y
-                );
+        if (server.xwayland != NULL) {
+            struct wlr_xcursor_manager *xcursor_manager =
+                hwd_xcursor_theme_acquire(cursor_theme, cursor_size);
+            assert(xcursor_manager);
+
+            if (xcursor_manager == server.xwayland->xcursor_manager) {
+                hwd_xcursor_theme_release(xcursor_manager);
+            } else {
+                hwd_xcursor_theme_release(server.xwayland->xcursor_manager);
+                server.xwayland->xcursor_manager = xcursor_manager;
+
+                wlr_xcursor_manager_load(xcursor_manager, 1);
+                struct wlr_xcursor *xcursor =
+                    wlr_xcursor_manager_get_xcursor(xcursor_manager, "left_ptr", 1);
+                if (xcursor != NULL) {
+                    struct wlr_xcursor_image *image = xcursor->images[0];
+                    wlr_xwayland_set_cursor(
+                        server.xwayland->xwayland, image->buffer, image->width * 4, image->width,
+                        image->height, image->hotspot_x, image->hotspot_y
+                    );
+                }
             }
         }
 #endif
     }
 
-    /* Create xcursor manager if we don't have one already, or if the
-     * theme has changed */
-    if (!seat->cursor->xcursor_manager ||
-        !xcursor_manager_is_named(seat->cursor->xcursor_manager, cursor_theme) ||
-        seat->cursor->xcursor_manager->size != cursor_size) {
-
-        wlr_xcursor_manager_destroy(seat->cursor->xcursor_manager);
-        seat->cursor->xcursor_manager = wlr_xcursor_manager_create(cursor_theme, cursor_size);
-        if (!seat->cursor->xcursor_manager) {
-            wlr_log(WLR_ERROR, "Cannot create XCursor manager for theme '%s'", cursor_theme);
-        }
-    }
-
-    for (int i = 0; i < root->outputs->length; ++i) {
-        struct hwd_output *hwd_output = root->outputs->items[i];
-        struct wlr_output *output = hwd_output->wlr_output;
-        bool result = wlr_xcursor_manager_load(seat->cursor->xcursor_manager, output->scale);
-        if (!result) {
-            wlr_log(
-                WLR_ERROR, "Cannot load xcursor theme for output '%s' with scale %f", output->name,
-                output->scale
-            );
-        }
+    // Themes are shared between seats, and wlr_cursor loads each scale the
+    // first time the cursor is shown on an output with that scale, so there is
+    // nothing to do unless the theme has changed.
+    struct wlr_xcursor_manager *xcursor_manager =
+        hwd_xcursor_theme_acquire(cursor_theme, cursor_size);
+    if (xcursor_manager == seat->cursor->xcursor_manager) {
+        hwd_xcursor_theme_release(xcursor_manager);
+        return;
     }
+    hwd_xcursor_theme_release(seat->cursor->xcursor_manager);
+    seat->cursor->xcursor_manager = xcursor_manager;
 
-    // Reset the cursor so that we apply it to outputs that just appeared
+    // Reset the cursor so that the new theme is applied.
     cursor_set_image(seat->cursor, NULL, NULL);
     cursor_set_image(seat->cursor, "left_ptr", NULL);
     wlr_cursor_warp(seat->cursor->cursor, NULL, seat->cursor->cursor->x, seat->cursor->cursor->y);
@@ -930,11 +930,150 @@ seat_pointer_notify_button(
         wlr_seat_pointer_notify_button(seat->wlr_seat, time_msec, button, state);
 }
 
+static void
+seatop_motion_cancel(struct hwd_seat *seat) {
+    seat->seatop_motion.pending = false;
+
+    if (seat->seatop_motion.output != NULL) {
+        wl_list_remove(&seat->seatop_motion.output_frame.link);
+        wl_list_remove(&seat->seatop_motion.output_destroy.link);
+        seat->seatop_motion.output = NULL;
+    }
+
+    if (seat->seatop_motion.waiting_transaction) {
+        wl_list_remove(&seat->seatop_motion.transaction_after_apply.link);
+        seat->seatop_motion.waiting_transaction = false;
+    }
+}
+
+static bool
+seatop_motion_transaction_in_flight(void) {
+    struct hwd_transaction_manager *transaction_manager = root_get_transaction_manager(root);
+
+    if (transaction_manager->queued) {
+        return true;
+    }
+
+    switch (transaction_manager->phase) {
+    case HWD_TRANSACTION_IDLE:
+    case HWD_TRANSACTION_AFTER_APPLY:
+        return false;
+    default:
+        return true;
+    }
+}
+
+/**
+ * Delivers any pending pointer motion to the seatop immediately, regardless of
+ * frame or transaction throttling.
+ */
+static void
+seatop_motion_flush(struct hwd_seat *seat) {
+    if (!seat->seatop_motion.pending) {
+        return;
+    }
+    seat->seatop_motion.pending = false;
+
+    const struct hwd_seatop_impl *impl = seat->seatop_impl;
+    impl->pointer_motion(seat, seat->seatop_motion.time_msec);
+
+    // The seatop may have ended itself in response to the motion.
+    if (seat->seatop_impl != impl || !impl->throttle_motion_configure) {
+        return;
+    }
+
+    if (seat->seatop_motion.waiting_transaction) {
+        return;
+    }
+
+    if (seatop_motion_transaction_in_flight()) {
+        struct hwd_transaction_manager *transaction_manager = root_get_transaction_manager(root);
+        wl_signal_add(
+            &transaction_manager->events.after_apply, &seat->seatop_motion.transaction_after_apply
+        );
+        seat->seatop_motion.waiting_transaction = true;
+    }
+}
+
+static void
+seatop_motion_schedule(struct hwd_seat *seat) {
+    if (seat->seatop_motion.output != NULL) {
+        return;
+    }
+
+    if (seat->seatop_motion.waiting_transaction) {
+        return;
+    }
+
+    struct wlr_cursor *cursor = seat->cursor->cursor;
+    struct hwd_output *output = root_get_output_at(root, cursor->x, cursor->y);
+    if (output == NULL) {
+        output = root_get_active_output(root);
+    }
+
+    if (output == NULL || !output->enabled) {
+        // Nothing to pace against.
+        seatop_motion_flush(seat);
+        return;
+    }
+
+    seat->seatop_motion.output = output->wlr_output;
+    wl_signal_add(&output->wlr_output->events.frame, &seat->seatop_motion.output_frame);
+    wl_signal_add(&output->wlr_output->events.destroy, &seat->seatop_motion.output_destroy);
+
+    wlr_output_schedule_frame(output->wlr_output);
+}
+
+static void
+handle_seatop_motion_output_frame(struct wl_listener *listener, void *data) {
+    struct hwd_seat *seat = wl_container_of(listener, seat, seatop_motion.output_frame);
+
+    wl_list_remove(&seat->seatop_motion.output_frame.link);
+    wl_list_remove(&seat->seatop_motion.output_destroy.link);
+    seat->seatop_motion.output = NULL;
+
+    seatop_motion_flush(seat);
+}
+
+static void
+handle_seatop_motion_output_destroy(struct wl_listener *listener, void *data) {
+    struct hwd_seat *seat = wl_container_of(listener, seat, seatop_motion.output_destroy);
+
+    wl_list_remove(&seat->seatop_motion.output_frame.link);
+    wl_list_remove(&seat->seatop_motion.output_destroy.link);
+    seat->seatop_motion.output = NULL;
+
+    seatop_motion_flush(seat);
+}
+
+static void
+handle_seatop_motion_transaction_after_apply(struct wl_listener *listener, void *data) {
+    struct hwd_seat *seat = wl_container_of(listener, seat, seatop_motion.transaction_after_apply);
+    struct hwd_transaction_manager *transaction_manager = root_get_transaction_manager(root);
+
+    // Changes made while the last transaction was waiting will go out in the
+    // next one.  Keep waiting until that has been applied as well.
+    if (transaction_manager->queued) {
+        return;
+    }
+
+    wl_list_remove(&seat->seatop_motion.transaction_after_apply.link);
+    seat->seatop_motion.waiting_transaction = false;
+
+    if (seat->seatop_motion.pending) {
+        seatop_motion_schedule(seat);
+    }
+}
+
 void
 seatop_button(
     struct hwd_seat *seat, uint32_t time_msec, struct wlr_input_device *device, uint32_t button,
     enum wl_pointer_button_state state
 ) {
+    // Make sure the seatop sees the final pointer position before it handles
+    // the button.
+    seatop_motion_flush(seat);
+
     if (seat->seatop_impl->button) {
         seat->seatop_impl->button(seat, time_msec, device, button, state);
     }
@@ -942,9 +1081,19 @@ seatop_button(
 
 void
 seatop_pointer_motion(struct hwd_seat *seat, uint32_t time_msec) {
-    if (seat->seatop_impl->pointer_motion) {
+    if (!seat->seatop_impl->pointer_motion) {
+        return;
+    }
+
+    if (!seat->seatop_impl->throttle_motion) {
         seat->seatop_impl->pointer_motion(seat, time_msec);
+        return;
     }
+
+    seat->seatop_motion.pending = true;
+    seat->seatop_motion.time_msec = time_msec;
+
+    seatop_motion_schedule(seat);
 }
 
 void
@@ -959,6 +1108,8 @@ seatop_tablet_tool_tip(
     struct hwd_seat *seat, struct hwd_tablet_tool *tool, uint32_t time_msec,
     enum wlr_tablet_tool_tip_state state
 ) {
+    seatop_motion_flush(seat);
+
     if (seat->seatop_impl->tablet_tool_tip) {
         seat->seatop_impl->tablet_tool_tip(seat, tool, time_msec, state);
     }
@@ -982,6 +1133,8 @@ seatop_rebase(struct hwd_seat *seat, uint32_t time_msec) {
 
 void
 seatop_end(struct hwd_seat *seat) {
+    seatop_motion_cancel(seat);
+
     if (seat->seatop_impl && seat->seatop_impl->end) {
         seat->seatop_impl->end(seat);
     }
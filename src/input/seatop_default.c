@@ -190,36 +190,36 @@ cursor_update_image(struct hwd_cursor *cursor, struct hwd_window *window) {
  */
 static struct hwd_binding *
 get_active_mouse_binding(
-    struct seatop_default_event *e, list_t *bindings, uint32_t modifiers, bool release,
+    struct seatop_default_event *e, struct hwd_mode *mode, uint32_t modifiers, bool release,
     bool on_titlebar, bool on_border, bool on_content, bool on_workspace, const char *identifier
 ) {
     uint32_t click_region = ((on_titlebar || on_workspace) ? BINDING_TITLEBAR : 0) |
         ((on_border || on_workspace) ? BINDING_BORDER : 0) |
         ((on_content || on_workspace) ? BINDING_CONTENTS : 0);
 
+    if (mode->mouse_binding_index == NULL) {
+        mode->mouse_binding_index = binding_index_create(mode->mouse_bindings);
+        if (mode->mouse_binding_index == NULL) {
+            return NULL;
+        }
+    }
+
+    // The index only returns bindings for exactly this combination of
+    // modifiers and buttons, so all that is left is to check the click region
+    // and prefer bindings for this specific device.
     struct hwd_binding *current = NULL;
-    for (int i = 0; i < bindings->length; ++i) {
-        struct hwd_binding *binding = bindings->items[i];
-        if (modifiers ^ binding->modifiers ||
-            e->pressed_button_count != (size_t)binding->keys->length ||
-            release != (binding->flags & BINDING_RELEASE) || !(click_region & binding->flags) ||
+    size_t iter = 0;
+    struct hwd_binding *binding;
+    while ((binding = binding_index_next(
+                mode->mouse_binding_index, modifiers, release, e->pressed_buttons,
+                e->pressed_button_count, &iter
+            )) != NULL) {
+        if (!(click_region & binding->flags) ||
             (on_workspace && (click_region & binding->flags) != click_region) ||
             (strcmp(binding->input, identifier) != 0 && strcmp(binding->input, "*") != 0)) {
             continue;
         }
 
-        bool match = true;
-        for (size_t j = 0; j < e->pressed_button_count; j++) {
-            uint32_t key = *(uint32_t *)binding->keys->items[j];
-            if (key != e->pressed_buttons[j]) {
-                match = false;
-                break;
-            }
-        }
-        if (!match) {
-            continue;
-        }
-
         if (!current || strcmp(current->input, "*") == 0) {
             current = binding;
             if (strcmp(current->input, identifier) == 0) {
@@ -379,13 +379,13 @@ trigger_pointer_button_binding(
     if (state == WL_POINTER_BUTTON_STATE_PRESSED) {
         state_add_button(e, button);
         binding = get_active_mouse_binding(
-            e, config->current_mode->mouse_bindings, modifiers, false, on_titlebar, on_border,
-            on_contents, on_workspace, device_identifier
+            e, config->current_mode, modifiers, false, on_titlebar, on_border, on_contents,
+            on_workspace, device_identifier
         );
     } else {
         binding = get_active_mouse_binding(
-            e, config->current_mode->mouse_bindings, modifiers, true, on_titlebar, on_border,
-            on_contents, on_workspace, device_identifier
+            e, config->current_mode, modifiers, true, on_titlebar, on_border, on_contents,
+            on_workspace, device_identifier
         );
         state_erase_button(e, button);
     }
@@ -787,8 +787,8 @@ handle_pointer_axis(struct hwd_seat *seat, struct wlr_pointer_axis_event *event)
     struct hwd_binding *binding = NULL;
     state_add_button(e, button);
     binding = get_active_mouse_binding(
-        e, config->current_mode->mouse_bindings, modifiers, false, on_titlebar, on_border,
-        on_contents, on_workspace, dev_id
+        e, config->current_mode, modifiers, false, on_titlebar, on_border, on_contents,
+        on_workspace, dev_id
     );
 
     if (binding) {
@@ -798,8 +798,8 @@ handle_pointer_axis(struct hwd_seat *seat, struct wlr_pointer_axis_event *event)
 
     // Handle mouse bindings - x11 mouse buttons 4-7 - release event
     binding = get_active_mouse_binding(
-        e, config->current_mode->mouse_bindings, modifiers, true, on_titlebar, on_border,
-        on_contents, on_workspace, dev_id
+        e, config->current_mode, modifiers, true, on_titlebar, on_border, on_contents,
+        on_workspace, dev_id
     );
     state_erase_button(e, button);
     if (binding) {
@@ -367,6 +367,7 @@ static const struct hwd_seatop_impl seatop_impl = {
     .tablet_tool_tip = handle_tablet_tool_tip,
     .end = handle_end,
     .unref = handle_unref,
+    .throttle_motion = true,
 };
 
 void
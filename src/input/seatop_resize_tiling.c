@@ -127,6 +127,8 @@ static const struct hwd_seatop_impl seatop_impl = {
     .button = handle_button,
     .pointer_motion = handle_pointer_motion,
     .unref = handle_unref,
+    .throttle_motion = true,
+    .throttle_motion_configure = true,
 };
 
 void
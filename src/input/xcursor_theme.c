@@ -0,0 +1,90 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/input/xcursor_theme.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_xcursor_manager.h>
+#include <wlr/util/log.h>
+
+struct hwd_xcursor_theme {
+    struct wlr_xcursor_manager *manager;
+    int refcount;
+
+    struct wl_list link; // themes
+};
+
+static struct wl_list themes = {&themes, &themes};
+
+static bool
+xcursor_theme_matches(struct hwd_xcursor_theme *theme, const char *name, unsigned size) {
+    struct wlr_xcursor_manager *manager = theme->manager;
+    if (manager->size != size) {
+        return false;
+    }
+    if (manager->name == NULL || name == NULL) {
+        return manager->name == name;
+    }
+    return strcmp(manager->name, name) == 0;
+}
+
+struct wlr_xcursor_manager *
+hwd_xcursor_theme_acquire(const char *name, unsigned size) {
+    struct hwd_xcursor_theme *theme;
+    wl_list_for_each(theme, &themes, link) {
+        if (xcursor_theme_matches(theme, name, size)) {
+            theme->refcount++;
+            return theme->manager;
+        }
+    }
+
+    theme = calloc(1, sizeof(struct hwd_xcursor_theme));
+    if (theme == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate hwd_xcursor_theme");
+        return NULL;
+    }
+
+    theme->manager = wlr_xcursor_manager_create(name, size);
+    if (theme->manager == NULL) {
+        wlr_log(WLR_ERROR, "Cannot create XCursor manager for theme '%s'", name);
+        free(theme);
+        return NULL;
+    }
+    theme->refcount = 1;
+    wl_list_insert(&themes, &theme->link);
+
+    return theme->manager;
+}
+
+void
+hwd_xcursor_theme_release(struct wlr_xcursor_manager *manager) {
+    if (manager == NULL) {
+        return;
+    }
+
+    struct hwd_xcursor_theme *theme;
+    wl_list_for_each(theme, &themes, link) {
+        if (theme->manager != manager) {
+            continue;
+        }
+
+        assert(theme->refcount > 0);
+        theme->refcount--;
+        if (theme->refcount == 0) {
+            wl_list_remove(&theme->link);
+            wlr_xcursor_manager_destroy(theme->manager);
+            free(theme);
+        }
+        return;
+    }
+
+    assert(false);
+}
@@ -0,0 +1,770 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/ipc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <wlr/util/log.h>
+
+#include <hayward/commands.h>
+#include <hayward/globals/root.h>
+#include <hayward/list.h>
+#include <hayward/profiler.h>
+#include <hayward/tree/column.h>
+#include <hayward/tree/output.h>
+#include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
+#include <hayward/tree/window.h>
+#include <hayward/tree/workspace.h>
+
+// Clients that let this much output build up are assumed to be stuck and are
+// disconnected.
+#define IPC_MAX_PENDING_OUTPUT (4 << 20)
+
+struct ipc_buffer {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+};
+
+struct hwd_ipc_client {
+    struct hwd_ipc *ipc;
+
+    int fd;
+    struct wl_event_source *source;
+    uint32_t event_mask;
+
+    uint32_t subscribed; // enum hwd_ipc_event_type
+
+    struct ipc_buffer input;
+
+    struct ipc_buffer output;
+    size_t output_offset;
+
+    struct wl_list link; // hwd_ipc::clients
+};
+
+struct hwd_ipc {
+    struct wl_event_loop *event_loop;
+
+    char *path;
+    int fd;
+    struct wl_event_source *source;
+
+    struct wl_list clients; // hwd_ipc_client::link
+
+    struct wl_listener transaction_after_apply;
+    struct wl_listener focus_changed;
+    struct wl_event_source *idle;
+
+    // Sections sent with the last event, used to detect which parts of the
+    // state have changed.  Emptied while no client is subscribed to them, as
+    // clients that subscribe later are sent the state at that point instead.
+    struct ipc_buffer tree;
+    struct ipc_buffer focus;
+    struct ipc_buffer workspace;
+
+    // Scratch buffers for building the next event.
+    struct ipc_buffer next_tree;
+    struct ipc_buffer next_focus;
+    struct ipc_buffer next_workspace;
+    struct ipc_buffer message;
+};
+
+static bool
+ipc_buffer_reserve(struct ipc_buffer *buffer, size_t length) {
+    if (buffer->length + length <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity < buffer->length + length) {
+        capacity *= 2;
+    }
+    uint8_t *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate IPC buffer");
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static bool
+ipc_buffer_append(struct ipc_buffer *buffer, const void *data, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    if (!ipc_buffer_reserve(buffer, length)) {
+        return false;
+    }
+    memcpy(&buffer->data[buffer->length], data, length);
+    buffer->length += length;
+    return true;
+}
+
+static bool
+ipc_buffer_append_uint32(struct ipc_buffer *buffer, uint32_t value) {
+    return ipc_buffer_append(buffer, &value, sizeof(value));
+}
+
+static bool
+ipc_buffer_append_int32(struct ipc_buffer *buffer, int32_t value) {
+    return ipc_buffer_append(buffer, &value, sizeof(value));
+}
+
+static bool
+ipc_buffer_append_uint64(struct ipc_buffer *buffer, uint64_t value) {
+    return ipc_buffer_append(buffer, &value, sizeof(value));
+}
+
+static bool
+ipc_buffer_append_string(struct ipc_buffer *buffer, const char *value) {
+    size_t length = value != NULL ? strlen(value) : 0;
+    return ipc_buffer_append_uint32(buffer, length) && ipc_buffer_append(buffer, value, length);
+}
+
+static void
+ipc_buffer_finish(struct ipc_buffer *buffer) {
+    free(buffer->data);
+    *buffer = (struct ipc_buffer){0};
+}
+
+static void
+ipc_buffer_swap(struct ipc_buffer *a, struct ipc_buffer *b) {
+    struct ipc_buffer tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static bool
+ipc_buffer_equal(struct ipc_buffer *a, struct ipc_buffer *b) {
+    return a->length == b->length && (a->length == 0 || memcmp(a->data, b->data, a->length) == 0);
+}
+
+static void
+ipc_client_destroy(struct hwd_ipc_client *client) {
+    wlr_log(WLR_DEBUG, "IPC client %d disconnected", client->fd);
+
+    wl_list_remove(&client->link);
+    wl_event_source_remove(client->source);
+    close(client->fd);
+    ipc_buffer_finish(&client->input);
+    ipc_buffer_finish(&client->output);
+    free(client);
+}
+
+// Writes as much pending output as the socket will take.  Returns false if the
+// client has gone away and has been destroyed.
+static bool
+ipc_client_flush(struct hwd_ipc_client *client) {
+    while (client->output_offset < client->output.length) {
+        ssize_t written = send(
+            client->fd, &client->output.data[client->output_offset],
+            client->output.length - client->output_offset, MSG_NOSIGNAL
+        );
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            wlr_log_errno(WLR_INFO, "Unable to write to IPC client");
+            ipc_client_destroy(client);
+            return false;
+        }
+        client->output_offset += written;
+    }
+
+    if (client->output_offset == client->output.length) {
+        client->output.length = 0;
+        client->output_offset = 0;
+    } else if (client->output.length - client->output_offset > IPC_MAX_PENDING_OUTPUT) {
+        wlr_log(WLR_ERROR, "IPC client %d is not reading, disconnecting", client->fd);
+        ipc_client_destroy(client);
+        return false;
+    }
+
+    uint32_t event_mask = WL_EVENT_READABLE;
+    if (client->output.length > 0) {
+        event_mask |= WL_EVENT_WRITABLE;
+    }
+    if (event_mask != client->event_mask) {
+        wl_event_source_fd_update(client->source, event_mask);
+        client->event_mask = event_mask;
+    }
+    return true;
+}
+
+static bool
+ipc_client_queue(
+    struct hwd_ipc_client *client, uint32_t type, const void *payload, size_t payload_length
+) {
+    return ipc_buffer_reserve(&client->output, HWD_IPC_HEADER_SIZE + payload_length) &&
+        ipc_buffer_append_uint32(&client->output, payload_length) &&
+        ipc_buffer_append_uint32(&client->output, type) &&
+        ipc_buffer_append(&client->output, payload, payload_length);
+}
+
+static void
+ipc_append_box(struct ipc_buffer *buffer, double x, double y, double width, double height) {
+    ipc_buffer_append_int32(buffer, (int32_t)x);
+    ipc_buffer_append_int32(buffer, (int32_t)y);
+    ipc_buffer_append_int32(buffer, (int32_t)width);
+    ipc_buffer_append_int32(buffer, (int32_t)height);
+}
+
+static void
+ipc_append_window(struct ipc_buffer *buffer, struct hwd_window *window) {
+    struct hwd_window_state *state = &window->current;
+
+    uint32_t flags = 0;
+    if (state->shaded) {
+        flags |= HWD_IPC_WINDOW_SHADED;
+    }
+    if (state->fullscreen) {
+        flags |= HWD_IPC_WINDOW_FULLSCREEN;
+    }
+
+    ipc_buffer_append_uint64(buffer, window->id);
+    ipc_buffer_append_uint64(buffer, window->output != NULL ? window->output->id : 0);
+    ipc_append_box(buffer, state->x, state->y, state->width, state->height);
+    ipc_buffer_append_uint32(buffer, flags);
+}
+
+static void
+ipc_build_tree(struct ipc_buffer *buffer) {
+    buffer->length = 0;
+
+    list_t *outputs = root->current.outputs;
+    ipc_buffer_append_uint32(buffer, outputs->length);
+    for (int i = 0; i < outputs->length; i++) {
+        struct hwd_output *output = outputs->items[i];
+        struct hwd_output_state *state = &output->current;
+
+        ipc_buffer_append_uint64(buffer, output->id);
+        ipc_buffer_append_string(buffer, output->wlr_output->name);
+        ipc_append_box(buffer, state->x, state->y, state->width, state->height);
+    }
+
+    list_t *workspaces = root->workspaces;
+    ipc_buffer_append_uint32(buffer, workspaces->length);
+    for (int i = 0; i < workspaces->length; i++) {
+        struct hwd_workspace *workspace = workspaces->items[i];
+        ipc_buffer_append_uint64(buffer, workspace->id);
+
+        list_t *columns = workspace->current.columns;
+        ipc_buffer_append_uint32(buffer, columns->length);
+        for (int j = 0; j < columns->length; j++) {
+            struct hwd_column *column = columns->items[j];
+            struct hwd_column_state *state = &column->current;
+
+            ipc_buffer_append_uint64(buffer, column->id);
+            ipc_buffer_append_uint64(buffer, column->output != NULL ? column->output->id : 0);
+            ipc_append_box(buffer, state->x, state->y, state->width, state->height);
+
+            ipc_buffer_append_uint32(buffer, state->children->length);
+            for (int k = 0; k < state->children->length; k++) {
+                ipc_append_window(buffer, state->children->items[k]);
+            }
+        }
+
+        list_t *floating = workspace->current.floating;
+        ipc_buffer_append_uint32(buffer, floating->length);
+        for (int j = 0; j < floating->length; j++) {
+            ipc_append_window(buffer, floating->items[j]);
+        }
+    }
+}
+
+static void
+ipc_build_focus(struct ipc_buffer *buffer) {
+    buffer->length = 0;
+
+    struct hwd_window *window = root->focused_window;
+    ipc_buffer_append_uint64(buffer, window != NULL ? window->id : 0);
+    ipc_buffer_append_string(buffer, window != NULL ? window->title : NULL);
+}
+
+static void
+ipc_build_workspace(struct ipc_buffer *buffer) {
+    buffer->length = 0;
+
+    list_t *workspaces = root->workspaces;
+    ipc_buffer_append_uint32(buffer, workspaces->length);
+    for (int i = 0; i < workspaces->length; i++) {
+        struct hwd_workspace *workspace = workspaces->items[i];
+
+        uint32_t flags = 0;
+        if (workspace == root->current.workspace) {
+            flags |= HWD_IPC_WORKSPACE_ACTIVE;
+        }
+        if (workspace->urgent) {
+            flags |= HWD_IPC_WORKSPACE_URGENT;
+        }
+
+        ipc_buffer_append_uint64(buffer, workspace->id);
+        ipc_buffer_append_string(buffer, workspace->name);
+        ipc_buffer_append_uint32(buffer, flags);
+    }
+}
+
+// Builds an event message with the sections for `changes` into `ipc->message`.
+static void
+ipc_build_event(
+    struct hwd_ipc *ipc, uint32_t changes, struct ipc_buffer *tree, struct ipc_buffer *focus,
+    struct ipc_buffer *workspace
+) {
+    struct ipc_buffer *message = &ipc->message;
+    message->length = 0;
+
+    ipc_buffer_append_uint32(message, changes);
+    if (changes & HWD_IPC_EVENT_TREE) {
+        ipc_buffer_append(message, tree->data, tree->length);
+    }
+    if (changes & HWD_IPC_EVENT_FOCUS) {
+        ipc_buffer_append(message, focus->data, focus->length);
+    }
+    if (changes & HWD_IPC_EVENT_WORKSPACE) {
+        ipc_buffer_append(message, workspace->data, workspace->length);
+    }
+}
+
+static void
+ipc_send_events(struct hwd_ipc *ipc, bool transaction_applied) {
+    HWD_PROFILER_TRACE();
+
+    uint32_t subscribed = 0;
+    struct hwd_ipc_client *client;
+    wl_list_for_each(client, &ipc->clients, link) {
+        subscribed |= client->subscribed;
+    }
+
+    // A built section is never empty, so once a section has been emptied the
+    // next change to it is always sent, whatever was sent before.
+    if (!(subscribed & HWD_IPC_EVENT_TREE)) {
+        ipc->tree.length = 0;
+    }
+    if (!(subscribed & HWD_IPC_EVENT_FOCUS)) {
+        ipc->focus.length = 0;
+    }
+    if (!(subscribed & HWD_IPC_EVENT_WORKSPACE)) {
+        ipc->workspace.length = 0;
+    }
+    if (subscribed == 0) {
+        return;
+    }
+
+    // The tree can only change when a transaction is applied.
+    uint32_t changes = 0;
+    if ((subscribed & HWD_IPC_EVENT_TREE) && transaction_applied) {
+        ipc_build_tree(&ipc->next_tree);
+        if (!ipc_buffer_equal(&ipc->next_tree, &ipc->tree)) {
+            ipc_buffer_swap(&ipc->next_tree, &ipc->tree);
+            changes |= HWD_IPC_EVENT_TREE;
+        }
+    }
+    if (subscribed & HWD_IPC_EVENT_FOCUS) {
+        ipc_build_focus(&ipc->next_focus);
+        if (!ipc_buffer_equal(&ipc->next_focus, &ipc->focus)) {
+            ipc_buffer_swap(&ipc->next_focus, &ipc->focus);
+            changes |= HWD_IPC_EVENT_FOCUS;
+        }
+    }
+    if (subscribed & HWD_IPC_EVENT_WORKSPACE) {
+        ipc_build_workspace(&ipc->next_workspace);
+        if (!ipc_buffer_equal(&ipc->next_workspace, &ipc->workspace)) {
+            ipc_buffer_swap(&ipc->next_workspace, &ipc->workspace);
+            changes |= HWD_IPC_EVENT_WORKSPACE;
+        }
+    }
+    if (changes == 0) {
+        return;
+    }
+
+    // Most clients subscribe to the same events, so only rebuild the message
+    // when the set of sections differs from the last client's.
+    uint32_t built = 0;
+    struct hwd_ipc_client *tmp;
+    wl_list_for_each_safe(client, tmp, &ipc->clients, link) {
+        uint32_t client_changes = changes & client->subscribed;
+        if (client_changes == 0) {
+            continue;
+        }
+        if (client_changes != built) {
+            ipc_build_event(ipc, client_changes, &ipc->tree, &ipc->focus, &ipc->workspace);
+            built = client_changes;
+        }
+        if (!ipc_client_queue(client, HWD_IPC_EVENT, ipc->message.data, ipc->message.length)) {
+            ipc_client_destroy(client);
+            continue;
+        }
+        ipc_client_flush(client);
+    }
+}
+
+static void
+ipc_handle_idle(void *data) {
+    struct hwd_ipc *ipc = data;
+    ipc->idle = NULL;
+
+    ipc_send_events(ipc, false);
+}
+
+static void
+ipc_handle_transaction_after_apply(struct wl_listener *listener, void *data) {
+    struct hwd_ipc *ipc = wl_container_of(listener, ipc, transaction_after_apply);
+
+    if (ipc->idle != NULL) {
+        wl_event_source_remove(ipc->idle);
+        ipc->idle = NULL;
+    }
+
+    ipc_send_events(ipc, true);
+}
+
+static void
+ipc_handle_focus_changed(struct wl_listener *listener, void *data) {
+    struct hwd_ipc *ipc = wl_container_of(listener, ipc, focus_changed);
+
+    // Focus changes made as part of a transaction are picked up once it is
+    // applied.  Otherwise wait until the current burst of events has been
+    // handled.
+    struct hwd_transaction_manager *transaction_manager = root_get_transaction_manager(root);
+    if (transaction_manager->queued || transaction_manager->phase != HWD_TRANSACTION_IDLE) {
+        return;
+    }
+    if (ipc->idle == NULL) {
+        ipc->idle = wl_event_loop_add_idle(ipc->event_loop, ipc_handle_idle, ipc);
+    }
+}
+
+static bool
+ipc_handle_run_command(struct hwd_ipc_client *client, const uint8_t *payload, uint32_t length) {
+    char *command = malloc(length + 1);
+    if (command == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate IPC command");
+        return false;
+    }
+    memcpy(command, payload, length);
+    command[length] = '\0';
+
+    wlr_log(WLR_DEBUG, "IPC client %d: executing '%s'", client->fd, command);
+    list_t *res_list = execute_command(command, NULL, NULL);
+    free(command);
+    if (res_list == NULL) {
+        return false;
+    }
+
+    struct hwd_ipc *ipc = client->ipc;
+    struct ipc_buffer *message = &ipc->message;
+    message->length = 0;
+    bool success = ipc_buffer_append_uint32(message, res_list->length);
+    for (int i = 0; i < res_list->length; ++i) {
+        struct cmd_results *res = res_list->items[i];
+        success = success && ipc_buffer_append_uint32(message, res->status) &&
+            ipc_buffer_append_string(message, res->error);
+        free_cmd_results(res);
+    }
+    list_free(res_list);
+
+    return success &&
+        ipc_client_queue(client, HWD_IPC_RUN_COMMAND, message->data, message->length);
+}
+
+static bool
+ipc_handle_subscribe(struct hwd_ipc_client *client, const uint8_t *payload, uint32_t length) {
+    uint32_t mask;
+    if (length != sizeof(mask)) {
+        wlr_log(WLR_ERROR, "IPC client %d sent malformed subscription", client->fd);
+        return false;
+    }
+    memcpy(&mask, payload, sizeof(mask));
+    client->subscribed = mask & HWD_IPC_EVENT_ALL;
+
+    if (!ipc_client_queue(
+            client, HWD_IPC_SUBSCRIBE, &client->subscribed, sizeof(client->subscribed)
+        )) {
+        return false;
+    }
+    if (client->subscribed == 0) {
+        return true;
+    }
+
+    // Give the client somewhere to start from.
+    struct hwd_ipc *ipc = client->ipc;
+    ipc_build_tree(&ipc->next_tree);
+    ipc_build_focus(&ipc->next_focus);
+    ipc_build_workspace(&ipc->next_workspace);
+    ipc_build_event(
+        ipc, client->subscribed, &ipc->next_tree, &ipc->next_focus, &ipc->next_workspace
+    );
+    return ipc_client_queue(client, HWD_IPC_EVENT, ipc->message.data, ipc->message.length);
+}
+
+// Handles every complete message in the input buffer.  Returns false if the
+// client should be disconnected.
+static bool
+ipc_client_handle_input(struct hwd_ipc_client *client) {
+    size_t offset = 0;
+    bool success = true;
+    while (success && client->input.length - offset >= HWD_IPC_HEADER_SIZE) {
+        uint32_t length, type;
+        memcpy(&length, &client->input.data[offset], sizeof(length));
+        memcpy(&type, &client->input.data[offset + sizeof(length)], sizeof(type));
+
+        if (length > HWD_IPC_MAX_PAYLOAD_SIZE) {
+            wlr_log(WLR_ERROR, "IPC client %d sent oversized message", client->fd);
+            return false;
+        }
+        if (client->input.length - offset - HWD_IPC_HEADER_SIZE < length) {
+            break;
+        }
+
+        const uint8_t *payload = &client->input.data[offset + HWD_IPC_HEADER_SIZE];
+        switch (type) {
+        case HWD_IPC_RUN_COMMAND:
+            success = ipc_handle_run_command(client, payload, length);
+            break;
+        case HWD_IPC_SUBSCRIBE:
+            success = ipc_handle_subscribe(client, payload, length);
+            break;
+        default:
+            wlr_log(WLR_ERROR, "IPC client %d sent unknown message type %u", client->fd, type);
+            success = false;
+            break;
+        }
+
+        offset += HWD_IPC_HEADER_SIZE + length;
+    }
+
+    memmove(client->input.data, &client->input.data[offset], client->input.length - offset);
+    client->input.length -= offset;
+    return success;
+}
+
+static int
+ipc_client_handle_event(int fd, uint32_t mask, void *data) {
+    HWD_PROFILER_TRACE();
+
+    struct hwd_ipc_client *client = data;
+
+    if (mask & WL_EVENT_ERROR) {
+        ipc_client_destroy(client);
+        return 0;
+    }
+
+    // Clients may send a command and hang up without waiting for the reply, so
+    // drain the socket before checking for hangup.
+    if (mask & (WL_EVENT_READABLE | WL_EVENT_HANGUP)) {
+        while (true) {
+            if (!ipc_buffer_reserve(&client->input, 4096)) {
+                ipc_client_destroy(client);
+                return 0;
+            }
+            ssize_t nread = recv(
+                fd, &client->input.data[client->input.length],
+                client->input.capacity - client->input.length, 0
+            );
+            if (nread < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                wlr_log_errno(WLR_INFO, "Unable to read from IPC client");
+                ipc_client_destroy(client);
+                return 0;
+            }
+            if (nread == 0) {
+                ipc_client_handle_input(client);
+                ipc_client_destroy(client);
+                return 0;
+            }
+            client->input.length += nread;
+
+            if (!ipc_client_handle_input(client)) {
+                ipc_client_destroy(client);
+                return 0;
+            }
+        }
+    }
+
+    ipc_client_flush(client);
+    return 0;
+}
+
+static int
+ipc_handle_connection(int fd, uint32_t mask, void *data) {
+    struct hwd_ipc *ipc = data;
+
+    int client_fd = accept(fd, NULL, NULL);
+    if (client_fd < 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to accept IPC client");
+        return 0;
+    }
+
+    int flags = fcntl(client_fd, F_GETFD);
+    if (flags < 0 || fcntl(client_fd, F_SETFD, flags | FD_CLOEXEC) < 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to set CLOEXEC on IPC client socket");
+        close(client_fd);
+        return 0;
+    }
+    flags = fcntl(client_fd, F_GETFL);
+    if (flags < 0 || fcntl(client_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to set NONBLOCK on IPC client socket");
+        close(client_fd);
+        return 0;
+    }
+
+    struct hwd_ipc_client *client = calloc(1, sizeof(struct hwd_ipc_client));
+    if (client == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate IPC client");
+        close(client_fd);
+        return 0;
+    }
+    client->ipc = ipc;
+    client->fd = client_fd;
+    client->event_mask = WL_EVENT_READABLE;
+    client->source = wl_event_loop_add_fd(
+        ipc->event_loop, client_fd, client->event_mask, ipc_client_handle_event, client
+    );
+    if (client->source == NULL) {
+        wlr_log(WLR_ERROR, "Unable to add IPC client to event loop");
+        close(client_fd);
+        free(client);
+        return 0;
+    }
+    wl_list_insert(&ipc->clients, &client->link);
+
+    wlr_log(WLR_DEBUG, "New IPC client %d", client_fd);
+    return 0;
+}
+
+struct hwd_ipc *
+hwd_ipc_create(struct wl_event_loop *event_loop) {
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir == NULL) {
+        wlr_log(WLR_ERROR, "XDG_RUNTIME_DIR is not set, not creating IPC socket");
+        return NULL;
+    }
+
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    int path_length = snprintf(
+        address.sun_path, sizeof(address.sun_path), "%s/hayward-ipc.%u.%i.sock", runtime_dir,
+        (unsigned)getuid(), (int)getpid()
+    );
+    if (path_length < 0 || (size_t)path_length >= sizeof(address.sun_path)) {
+        wlr_log(WLR_ERROR, "IPC socket path is too long");
+        return NULL;
+    }
+
+    struct hwd_ipc *ipc = calloc(1, sizeof(struct hwd_ipc));
+    if (ipc == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate hwd_ipc");
+        return NULL;
+    }
+    ipc->event_loop = event_loop;
+    ipc->fd = -1;
+    wl_list_init(&ipc->clients);
+
+    ipc->path = strdup(address.sun_path);
+    if (ipc->path == NULL) {
+        goto error;
+    }
+
+    ipc->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (ipc->fd < 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to create IPC socket");
+        goto error;
+    }
+
+    unlink(ipc->path);
+    if (bind(ipc->fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to bind IPC socket");
+        goto error;
+    }
+    if (listen(ipc->fd, 16) != 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to listen on IPC socket");
+        goto error;
+    }
+
+    ipc->source =
+        wl_event_loop_add_fd(event_loop, ipc->fd, WL_EVENT_READABLE, ipc_handle_connection, ipc);
+    if (ipc->source == NULL) {
+        wlr_log(WLR_ERROR, "Unable to add IPC socket to event loop");
+        goto error;
+    }
+
+    ipc->transaction_after_apply.notify = ipc_handle_transaction_after_apply;
+    wl_signal_add(
+        &root_get_transaction_manager(root)->events.after_apply, &ipc->transaction_after_apply
+    );
+    ipc->focus_changed.notify = ipc_handle_focus_changed;
+    wl_signal_add(&root->events.focus_changed, &ipc->focus_changed);
+
+    setenv("HAYWARDSOCK", ipc->path, true);
+    wlr_log(WLR_INFO, "Listening for IPC clients on %s", ipc->path);
+
+    return ipc;
+
+error:
+    if (ipc->fd >= 0) {
+        close(ipc->fd);
+        unlink(ipc->path);
+    }
+    free(ipc->path);
+    free(ipc);
+    return NULL;
+}
+
+void
+hwd_ipc_destroy(struct hwd_ipc *ipc) {
+    if (ipc == NULL) {
+        return;
+    }
+
+    struct hwd_ipc_client *client, *tmp;
+    wl_list_for_each_safe(client, tmp, &ipc->clients, link) {
+        ipc_client_destroy(client);
+    }
+
+    wl_list_remove(&ipc->transaction_after_apply.link);
+    wl_list_remove(&ipc->focus_changed.link);
+    if (ipc->idle != NULL) {
+        wl_event_source_remove(ipc->idle);
+    }
+    wl_event_source_remove(ipc->source);
+
+    close(ipc->fd);
+    unlink(ipc->path);
+    free(ipc->path);
+
+    ipc_buffer_finish(&ipc->tree);
+    ipc_buffer_finish(&ipc->focus);
+    ipc_buffer_finish(&ipc->workspace);
+    ipc_buffer_finish(&ipc->next_tree);
+    ipc_buffer_finish(&ipc->next_focus);
+    ipc_buffer_finish(&ipc->next_workspace);
+    ipc_buffer_finish(&ipc->message);
+    free(ipc);
+}
@@ -0,0 +1,311 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/latency.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <wayland-util.h>
+
+#include <wlr/util/log.h>
+
+// Number of recent input events remembered.
+#define INPUT_RING_SIZE 64
+
+// Input events received more than this many refresh periods before a frame are
+// assumed not to have caused it.  An output that has been idle will otherwise
+// attribute an unrelated repaint, such as a clock ticking in a bar, to input
+// that it received long ago.
+#define INPUT_MAX_AGE_FRAMES 2
+
+// Refresh period to assume for outputs that have not presented a frame yet, or
+// that have a variable refresh rate.
+#define DEFAULT_REFRESH_NSEC 16666667
+
+struct input_event_record {
+    uint64_t serial;
+    uint64_t nsec;
+};
+
+static struct {
+    uint64_t serial;
+    struct input_event_record ring[INPUT_RING_SIZE];
+} input_events;
+
+static struct {
+    // Time of the most recent switch that has not yet been applied.
+    bool requested;
+    uint64_t requested_nsec;
+
+    // Serial and request time of the most recently applied switch.
+    uint64_t serial;
+    uint64_t nsec;
+} workspace_switch;
+
+static struct wl_list hwd_latency_outputs = {
+    .prev = &hwd_latency_outputs, .next = &hwd_latency_outputs
+};
+
+static uint64_t
+timespec_to_nsec(const struct timespec *ts) {
+    return (uint64_t)ts->tv_sec * 1000000000 + (uint64_t)ts->tv_nsec;
+}
+
+static uint64_t
+now_nsec(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return timespec_to_nsec(&now);
+}
+
+static void
+histogram_add(struct hwd_latency_histogram *histogram, uint64_t begin_nsec, uint64_t end_nsec) {
+    uint64_t usec = end_nsec > begin_nsec ? (end_nsec - begin_nsec) / 1000 : 0;
+
+    size_t bucket = 0;
+    while (bucket + 1 < HWD_LATENCY_HISTOGRAM_BUCKETS && usec >> (bucket + 1) != 0) {
+        bucket++;
+    }
+
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->total_usec += usec;
+    if (usec > histogram->max_usec) {
+        histogram->max_usec = usec;
+    }
+}
+
+void
+hwd_latency_notify_input(void) {
+    input_events.serial++;
+
+    struct input_event_record *record =
+        &input_events.ring[input_events.serial % INPUT_RING_SIZE];
+    record->serial = input_events.serial;
+    record->nsec = now_nsec();
+}
+
+void
+hwd_latency_notify_workspace_switch(void) {
+    // Only the most recent switch matters.  Earlier switches that have not yet
+    // been applied have been superseded.
+    workspace_switch.requested = true;
+    workspace_switch.requested_nsec = now_nsec();
+}
+
+void
+hwd_latency_notify_workspace_switch_applied(void) {
+    if (!workspace_switch.requested) {
+        return;
+    }
+    workspace_switch.requested = false;
+
+    // Frames committed before this point still showed the old workspace, so
+    // only frames committed from now on can claim the switch.
+    workspace_switch.serial++;
+    workspace_switch.nsec = workspace_switch.requested_nsec;
+}
+
+struct hwd_latency_output *
+hwd_latency_output_create(const char *name) {
+    struct hwd_latency_output *output = calloc(1, sizeof(struct hwd_latency_output));
+    assert(output != NULL);
+
+    output->name = strdup(name);
+    output->refresh_nsec = DEFAULT_REFRESH_NSEC;
+    output->input_serial = input_events.serial;
+    output->switch_serial = workspace_switch.serial;
+
+    wl_list_insert(&hwd_latency_outputs, &output->link);
+
+    return output;
+}
+
+void
+hwd_latency_output_destroy(struct hwd_latency_output *output) {
+    wl_list_remove(&output->link);
+    free(output->name);
+    free(output);
+}
+
+void
+hwd_latency_output_commit(struct hwd_latency_output *output) {
+    if (output->switch_serial != workspace_switch.serial) {
+        output->switch_serial = workspace_switch.serial;
+        output->switch_frame_pending = true;
+        output->switch_frame_nsec = workspace_switch.nsec;
+    }
+
+    if (output->input_serial == input_events.serial) {
+        // No input since the last frame.  Whatever changed was not caused by
+        // the user.
+        return;
+    }
+
+    uint64_t serial = output->input_serial + 1;
+    if (input_events.serial - serial >= INPUT_RING_SIZE) {
+        serial = input_events.serial - INPUT_RING_SIZE + 1;
+    }
+    output->input_serial = input_events.serial;
+
+    // Find the oldest event that is recent enough to have caused this frame.
+    uint64_t now = now_nsec();
+    uint64_t max_age_nsec = INPUT_MAX_AGE_FRAMES * output->refresh_nsec;
+    struct input_event_record *record = NULL;
+    for (; serial <= input_events.serial; serial++) {
+        struct input_event_record *candidate = &input_events.ring[serial % INPUT_RING_SIZE];
+        assert(candidate->serial == serial);
+        if (now - candidate->nsec <= max_age_nsec) {
+            record = candidate;
+            break;
+        }
+    }
+    if (record == NULL) {
+        return;
+    }
+
+    histogram_add(&output->event_to_commit, record->nsec, now);
+
+    // If a previous frame was never presented its input is superseded by this
+    // one, which is older or the same.
+    output->frame_pending = true;
+    output->frame_input_nsec = record->nsec;
+}
+
+void
+hwd_latency_output_present(
+    struct hwd_latency_output *output, const struct timespec *when, int refresh_nsec
+) {
+    if (refresh_nsec > 0) {
+        output->refresh_nsec = refresh_nsec;
+    }
+
+    if (output->switch_frame_pending) {
+        output->switch_frame_pending = false;
+        histogram_add(&output->switch_to_present, output->switch_frame_nsec, timespec_to_nsec(when));
+    }
+
+    if (output->frame_pending) {
+        output->frame_pending = false;
+        histogram_add(&output->event_to_present, output->frame_input_nsec, timespec_to_nsec(when));
+    }
+}
+
+void
+hwd_latency_output_discard(struct hwd_latency_output *output) {
+    output->frame_pending = false;
+    output->switch_frame_pending = false;
+}
+
+static uint64_t
+histogram_percentile(const struct hwd_latency_histogram *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    uint64_t threshold = (uint64_t)(histogram->count * percentile / 100.0);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < HWD_LATENCY_HISTOGRAM_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen > threshold) {
+            // Report the upper bound of the bucket, capped at the largest
+            // sample actually seen.
+            uint64_t upper = ((uint64_t)1 << (bucket + 1)) - 1;
+            return upper < histogram->max_usec ? upper : histogram->max_usec;
+        }
+    }
+
+    return histogram->max_usec;
+}
+
+static void
+report_line(FILE *report, const char *format, ...) {
+    char line[256];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    wlr_log(WLR_INFO, "%s", line);
+    fprintf(report, "%s\n", line);
+}
+
+static void
+histogram_dump(
+    FILE *report, const char *output_name, const char *label,
+    struct hwd_latency_histogram *histogram
+) {
+    if (histogram->count == 0) {
+        report_line(report, "latency %s %s: no samples", output_name, label);
+        return;
+    }
+
+    report_line(
+        report,
+        "latency %s %s: count=%" PRIu64 " mean=%" PRIu64 "us p50<=%" PRIu64 "us p90<=%" PRIu64
+        "us p99<=%" PRIu64 "us max=%" PRIu64 "us",
+        output_name, label, histogram->count, histogram->total_usec / histogram->count,
+        histogram_percentile(histogram, 50),
+        histogram_percentile(histogram, 90),
+        histogram_percentile(histogram, 99), histogram->max_usec
+    );
+
+    for (size_t bucket = 0; bucket < HWD_LATENCY_HISTOGRAM_BUCKETS; bucket++) {
+        if (histogram->buckets[bucket] == 0) {
+            continue;
+        }
+        uint64_t lower = bucket == 0 ? 0 : (uint64_t)1 << bucket;
+        uint64_t upper = (uint64_t)1 << (bucket + 1);
+        report_line(
+            report, "latency %s %s:   [%" PRIu64 "us, %" PRIu64 "us) %" PRIu64, output_name,
+            label, lower, upper, histogram->buckets[bucket]
+        );
+    }
+}
+
+char *
+hwd_latency_dump(void) {
+    char *buffer = NULL;
+    size_t length = 0;
+    FILE *report = open_memstream(&buffer, &length);
+    if (report == NULL) {
+        wlr_log_errno(WLR_ERROR, "Unable to allocate latency report");
+        return NULL;
+    }
+
+    struct hwd_latency_output *output;
+    wl_list_for_each(output, &hwd_latency_outputs, link) {
+        histogram_dump(report, output->name, "event->commit", &output->event_to_commit);
+        histogram_dump(report, output->name, "event->present", &output->event_to_present);
+        histogram_dump(report, output->name, "switch->present", &output->switch_to_present);
+    }
+
+    if (fclose(report) != 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to allocate latency report");
+        free(buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+void
+hwd_latency_reset(void) {
+    struct hwd_latency_output *output;
+    wl_list_for_each(output, &hwd_latency_outputs, link) {
+        memset(&output->event_to_commit, 0, sizeof(output->event_to_commit));
+        memset(&output->event_to_present, 0, sizeof(output->event_to_present));
+        memset(&output->switch_to_present, 0, sizeof(output->switch_to_present));
+    }
+}
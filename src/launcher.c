@@ -0,0 +1,284 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/launcher.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <wlr/util/log.h>
+
+#include <hayward/server.h>
+
+extern char **environ;
+
+// Compositor's end of the socket connected to the helper, or -1 if the helper
+// is not running.
+static int launcher_fd = -1;
+static pid_t launcher_pid = -1;
+
+// Called in a freshly forked child.  Does not return.
+static void
+launcher_exec(const char *cmd) {
+    setsid();
+    sigset_t set;
+    sigemptyset(&set);
+    sigprocmask(SIG_SETMASK, &set, NULL);
+    signal(SIGPIPE, SIG_DFL);
+    signal(SIGCHLD, SIG_DFL);
+    execlp("sh", "sh", "-c", cmd, (void *)NULL);
+    wlr_log_errno(WLR_ERROR, "execlp failed");
+    _exit(1);
+}
+
+// Requests are the command followed by each variable in the environment, all
+// terminated by NUL.  Responses are the pid of the new process, or -1.
+static pid_t
+launcher_handle_request(char *request, size_t size) {
+    char *cmd = request;
+    char *end = request + size;
+
+    size_t num_env = 0;
+    for (char *var = cmd + strlen(cmd) + 1; var < end; var += strlen(var) + 1) {
+        num_env++;
+    }
+
+    char **env = calloc(num_env + 1, sizeof(char *));
+    if (env == NULL) {
+        wlr_log(WLR_ERROR, "Launcher: unable to allocate environment");
+        return -1;
+    }
+    size_t i = 0;
+    for (char *var = cmd + strlen(cmd) + 1; var < end; var += strlen(var) + 1) {
+        env[i++] = var;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        environ = env;
+        launcher_exec(cmd);
+    } else if (pid < 0) {
+        wlr_log_errno(WLR_ERROR, "Launcher: fork failed");
+    }
+    free(env);
+    return pid;
+}
+
+static void
+launcher_run(int fd) {
+    // Only fds 0-2 and the socket are needed.  Anything else was opened by the
+    // backend before the helper was forked and shouldn't be kept alive by it.
+    long max_fd = sysconf(_SC_OPEN_MAX);
+    if (max_fd < 0) {
+        max_fd = 1024;
+    }
+    for (int i = 3; i < max_fd; i++) {
+        if (i != fd) {
+            close(i);
+        }
+    }
+
+    // Processes are launched in their own session and never waited on, so
+    // have the kernel reap them.
+    signal(SIGCHLD, SIG_IGN);
+
+    char *buffer = NULL;
+    size_t capacity = 0;
+    while (true) {
+        ssize_t size = recv(fd, NULL, 0, MSG_PEEK | MSG_TRUNC);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            // Compositor has exited.
+            break;
+        }
+
+        if ((size_t)size + 1 > capacity) {
+            char *new_buffer = realloc(buffer, size + 1);
+            if (new_buffer == NULL) {
+                wlr_log(WLR_ERROR, "Launcher: unable to allocate request buffer");
+                recv(fd, NULL, 0, 0);
+                pid_t pid = -1;
+                send(fd, &pid, sizeof(pid), MSG_NOSIGNAL);
+                continue;
+            }
+            buffer = new_buffer;
+            capacity = size + 1;
+        }
+
+        size = recv(fd, buffer, size, 0);
+        if (size <= 0) {
+            break;
+        }
+        buffer[size] = '\0';
+
+        pid_t pid = launcher_handle_request(buffer, size);
+        if (send(fd, &pid, sizeof(pid), MSG_NOSIGNAL) != sizeof(pid)) {
+            break;
+        }
+    }
+
+    free(buffer);
+    _exit(0);
+}
+
+bool
+hwd_launcher_init(void) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to create launcher socket");
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        launcher_run(fds[1]);
+    } else if (pid < 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to fork launcher");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    close(fds[1]);
+    launcher_fd = fds[0];
+    launcher_pid = pid;
+    wlr_log(WLR_DEBUG, "Launcher started with pid %d", pid);
+    return true;
+}
+
+static void
+launcher_stop(bool wait) {
+    if (launcher_fd >= 0) {
+        close(launcher_fd);
+        launcher_fd = -1;
+    }
+    if (launcher_pid > 0) {
+        // The helper exits as soon as it sees its end of the socket close.
+        waitpid(launcher_pid, NULL, wait ? 0 : WNOHANG);
+        launcher_pid = -1;
+    }
+}
+
+void
+hwd_launcher_finish(void) {
+    launcher_stop(true);
+}
+
+static bool
+launcher_request(const char *cmd, pid_t *pid) {
+    size_t size = strlen(cmd) + 1;
+    for (char **var = environ; *var != NULL; var++) {
+        size += strlen(*var) + 1;
+    }
+
+    char *request = malloc(size);
+    if (request == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate launcher request");
+        return false;
+    }
+    char *pos = request;
+    size_t length = strlen(cmd) + 1;
+    memcpy(pos, cmd, length);
+    pos += length;
+    for (char **var = environ; *var != NULL; var++) {
+        length = strlen(*var) + 1;
+        memcpy(pos, *var, length);
+        pos += length;
+    }
+
+    ssize_t sent = send(launcher_fd, request, size, MSG_NOSIGNAL);
+    free(request);
+    if (sent != (ssize_t)size) {
+        wlr_log_errno(WLR_ERROR, "Unable to send request to launcher");
+        return false;
+    }
+
+    ssize_t received;
+    do {
+        received = recv(launcher_fd, pid, sizeof(*pid), 0);
+    } while (received < 0 && errno == EINTR);
+    if (received != sizeof(*pid)) {
+        wlr_log(WLR_ERROR, "No response from launcher");
+        return false;
+    }
+    return true;
+}
+
+static pid_t
+launcher_spawn_fork(const char *cmd) {
+    int fd[2];
+    if (pipe(fd) != 0) {
+        wlr_log(WLR_ERROR, "Unable to create pipe for fork");
+        return -1;
+    }
+
+    pid_t pid, child = -1;
+    // Fork process
+    if ((pid = fork()) == 0) {
+        // Fork child process again
+        restore_nofile_limit();
+        close(fd[0]);
+        if ((child = fork()) == 0) {
+            close(fd[1]);
+            launcher_exec(cmd);
+        }
+        ssize_t s = 0;
+        while ((size_t)s < sizeof(pid_t)) {
+            s += write(fd[1], ((uint8_t *)&child) + s, sizeof(pid_t) - s);
+        }
+        close(fd[1]);
+        _exit(0); // Close child process
+    } else if (pid < 0) {
+        wlr_log_errno(WLR_ERROR, "fork() failed");
+        close(fd[0]);
+        close(fd[1]);
+        return -1;
+    }
+    close(fd[1]); // close write
+    ssize_t s = 0;
+    while ((size_t)s < sizeof(pid_t)) {
+        ssize_t n = read(fd[0], ((uint8_t *)&child) + s, sizeof(pid_t) - s);
+        if (n <= 0) {
+            child = -1;
+            break;
+        }
+        s += n;
+    }
+    close(fd[0]);
+    // cleanup child process
+    waitpid(pid, NULL, 0);
+    if (child <= 0) {
+        wlr_log(WLR_ERROR, "Second fork() failed");
+        return -1;
+    }
+    return child;
+}
+
+pid_t
+hwd_launcher_spawn(const char *cmd) {
+    if (launcher_fd >= 0) {
+        pid_t pid;
+        if (launcher_request(cmd, &pid)) {
+            return pid;
+        }
+
+        wlr_log(WLR_ERROR, "Launcher is not responding, falling back to fork");
+        launcher_stop(false);
+    }
+
+    return launcher_spawn_fork(cmd);
+}
@@ -6,6 +6,7 @@
 #include "hayward/list.h"
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -78,6 +79,31 @@ list_cat(list_t *list, list_t *source) {
     }
 }
 
+bool
+list_update(list_t *list, int index, void *item) {
+    assert(index >= 0 && index <= list->length);
+
+    if (index < list->length && list->items[index] == item) {
+        return false;
+    }
+
+    list->length = index;
+    list_add(list, item);
+    return true;
+}
+
+bool
+list_truncate(list_t *list, int length) {
+    assert(length >= 0);
+
+    if (list->length <= length) {
+        return false;
+    }
+
+    list->length = length;
+    return true;
+}
+
 void
 list_qsort(list_t *list, int compare(const void *left, const void *right)) {
     qsort(list->items, list->length, sizeof(void *), compare);
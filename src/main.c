@@ -25,7 +25,9 @@
 #include <hayward/config.h>
 #include <hayward/globals/root.h>
 #include <hayward/haywardnag.h>
+#include <hayward/launcher.h>
 #include <hayward/profiler.h>
+#include <hayward/recorder.h>
 #include <hayward/server.h>
 #include <hayward/theme.h>
 #include <hayward/tree/root.h>
@@ -226,10 +228,26 @@ enable_debug_flag(const char *flag) {
         debug.noatomic = true;
     } else if (strcmp(flag, "txn-wait") == 0) {
         debug.txn_wait = true;
+    } else if (strcmp(flag, "txn-stats") == 0) {
+        debug.txn_stats = true;
+    } else if (strcmp(flag, "validate") == 0) {
+        debug.validate = true;
     } else if (strcmp(flag, "profile") == 0) {
         hwd_profiler_init();
     } else if (strncmp(flag, "txn-timeout=", 12) == 0) {
         server.txn_timeout_ms = atoi(&flag[12]);
+    } else if (strncmp(flag, "watchdog=", 9) == 0) {
+        server.watchdog_timeout_ms = atoi(&flag[9]);
+    } else if (strncmp(flag, "record=", 7) == 0) {
+        hwd_recorder_open(&flag[7]);
+    } else if (strncmp(flag, "replay=", 7) == 0) {
+        free(server.replay_path);
+        server.replay_path = strdup(&flag[7]);
+    } else if (strncmp(flag, "replay-client=", 14) == 0) {
+        free(server.replay_client);
+        server.replay_client = strdup(&flag[14]);
+    } else if (strcmp(flag, "replay-fast") == 0) {
+        server.replay_fast = true;
     } else {
         wlr_log(WLR_ERROR, "Unknown debug flag: %s", flag);
     }
@@ -352,6 +370,12 @@ main(int argc, char **argv) {
         exit(EXIT_FAILURE);
     }
 
+    // Start the launcher while the compositor is still small, and before the
+    // open files limit is raised, so that processes inherit the original.
+    if (!validate) {
+        hwd_launcher_init();
+    }
+
     increase_nofile_limit();
 
     // handle SIGTERM signals
@@ -416,6 +440,12 @@ shutdown:
     free(config_path);
     free_config(config);
 
+    hwd_launcher_finish();
+
+    hwd_recorder_close();
+    free(server.replay_path);
+    free(server.replay_client);
+
     pango_cairo_font_map_set_default(NULL);
 
     return exit_value;
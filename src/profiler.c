@@ -0,0 +1,34 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/profiler.h"
+
+#include <dlfcn.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+struct hwd_profiler_stack hwd_profiler_stack;
+bool hwd_profiler_stack_enabled;
+
+static size_t (*allocation_count)(void);
+static bool allocation_count_resolved;
+
+size_t
+hwd_profiler_allocation_count(void) {
+    if (!allocation_count_resolved) {
+        allocation_count_resolved = true;
+
+        void *self = dlopen(NULL, RTLD_LAZY);
+        if (self != NULL) {
+            allocation_count = (size_t(*)(void))dlsym(self, "hwd_bench_allocation_count");
+            dlclose(self);
+        }
+    }
+
+    if (allocation_count == NULL) {
+        return 0;
+    }
+    return allocation_count();
+}
@@ -0,0 +1,170 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/recorder.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_output.h>
+#include <wlr/types/wlr_output_layout.h>
+#include <wlr/util/log.h>
+
+#include <hayward/profiler.h>
+
+static struct {
+    FILE *file;
+    hwd_timestamp last_record;
+} recorder;
+
+static void
+write_uint(uint64_t value) {
+    uint8_t bytes[10];
+    size_t length = 0;
+
+    do {
+        bytes[length] = value & 0x7f;
+        value >>= 7;
+        if (value != 0) {
+            bytes[length] |= 0x80;
+        }
+        length++;
+    } while (value != 0);
+
+    fwrite(bytes, 1, length, recorder.file);
+}
+
+static void
+write_int(int64_t value) {
+    write_uint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void
+write_string(const char *value) {
+    size_t length = strlen(value);
+    write_uint(length);
+    fwrite(value, 1, length, recorder.file);
+}
+
+static void
+begin_record(enum hwd_recorder_record_type type) {
+    hwd_timestamp now = hwd_profiler_now();
+
+    fputc(type, recorder.file);
+    write_uint((now - recorder.last_record) / 1000);
+
+    recorder.last_record = now;
+}
+
+static void
+end_record(void) {
+    // Flushed eagerly so that the log is still useful if the compositor
+    // crashes, which is often the reason for recording in the first place.
+    fflush(recorder.file);
+}
+
+bool
+hwd_recorder_open(const char *path) {
+    if (recorder.file != NULL) {
+        hwd_recorder_close();
+    }
+
+    recorder.file = fopen(path, "wb");
+    if (recorder.file == NULL) {
+        wlr_log_errno(WLR_ERROR, "Unable to open recording %s", path);
+        return false;
+    }
+
+    fwrite(HWD_RECORDER_MAGIC, 1, HWD_RECORDER_MAGIC_SIZE, recorder.file);
+    recorder.last_record = hwd_profiler_now();
+
+    wlr_log(WLR_INFO, "Recording to %s", path);
+
+    return true;
+}
+
+void
+hwd_recorder_close(void) {
+    if (recorder.file == NULL) {
+        return;
+    }
+
+    fclose(recorder.file);
+    recorder.file = NULL;
+}
+
+void
+hwd_recorder_command(const char *command) {
+    if (recorder.file == NULL) {
+        return;
+    }
+
+    begin_record(HWD_RECORDER_COMMAND);
+    write_string(command);
+    end_record();
+}
+
+void
+hwd_recorder_window_map(size_t window_id) {
+    if (recorder.file == NULL) {
+        return;
+    }
+
+    begin_record(HWD_RECORDER_WINDOW_MAP);
+    write_uint(window_id);
+    end_record();
+}
+
+void
+hwd_recorder_window_unmap(size_t window_id) {
+    if (recorder.file == NULL) {
+        return;
+    }
+
+    begin_record(HWD_RECORDER_WINDOW_UNMAP);
+    write_uint(window_id);
+    end_record();
+}
+
+void
+hwd_recorder_window_configure(size_t window_id, uint64_t latency_nsec) {
+    if (recorder.file == NULL) {
+        return;
+    }
+
+    begin_record(HWD_RECORDER_WINDOW_CONFIGURE);
+    write_uint(window_id);
+    write_uint(latency_nsec / 1000);
+    end_record();
+}
+
+void
+hwd_recorder_output_layout(struct wlr_output_layout *output_layout) {
+    if (recorder.file == NULL) {
+        return;
+    }
+
+    begin_record(HWD_RECORDER_OUTPUT_LAYOUT);
+
+    write_uint(wl_list_length(&output_layout->outputs));
+
+    struct wlr_output_layout_output *layout_output;
+    wl_list_for_each(layout_output, &output_layout->outputs, link) {
+        struct wlr_output *output = layout_output->output;
+
+        write_int(layout_output->x);
+        write_int(layout_output->y);
+        write_uint(output->width);
+        write_uint(output->height);
+        write_uint((uint64_t)(output->scale * 1000.0f + 0.5f));
+    }
+
+    end_record();
+}
@@ -0,0 +1,575 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/replay.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <wlr/backend.h>
+#include <wlr/backend/headless.h>
+#include <wlr/backend/multi.h>
+#include <wlr/types/wlr_output.h>
+#include <wlr/types/wlr_output_layout.h>
+#include <wlr/util/log.h>
+
+#include <hayward/commands.h>
+#include <hayward/globals/root.h>
+#include <hayward/list.h>
+#include <hayward/profiler.h>
+#include <hayward/recorder.h>
+#include <hayward/server.h>
+#include <hayward/tree/output.h>
+#include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
+#include <hayward/util.h>
+
+// How often to check whether the compositor has settled when replaying as fast
+// as possible.
+#define REPLAY_POLL_MS 1
+
+struct hwd_replay {
+    struct wl_event_loop *event_loop;
+    bool fast;
+
+    uint8_t *data;
+    size_t size;
+    size_t offset;
+
+    // Header of the next record to be replayed.  `next_time` is relative to
+    // the start of the replay.
+    bool has_next;
+    enum hwd_recorder_record_type next_type;
+    hwd_timestamp next_time;
+
+    hwd_timestamp begin;
+    struct wl_event_source *timer;
+
+    struct wl_client *client;
+    struct wl_listener client_destroy;
+    int client_in;
+    int client_out;
+    struct wl_event_source *client_out_source;
+
+    // Number of maps and unmaps sent to the client that it has not yet
+    // reported as complete.
+    size_t num_outstanding;
+};
+
+static bool
+read_uint(struct hwd_replay *replay, uint64_t *value) {
+    *value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (replay->offset >= replay->size) {
+            return false;
+        }
+        uint8_t byte = replay->data[replay->offset++];
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool
+read_int(struct hwd_replay *replay, int64_t *value) {
+    uint64_t encoded;
+    if (!read_uint(replay, &encoded)) {
+        return false;
+    }
+    *value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+    return true;
+}
+
+static char *
+read_string(struct hwd_replay *replay) {
+    uint64_t length;
+    if (!read_uint(replay, &length) || length > replay->size - replay->offset) {
+        return NULL;
+    }
+
+    char *value = malloc(length + 1);
+    if (value == NULL) {
+        return NULL;
+    }
+    memcpy(value, &replay->data[replay->offset], length);
+    value[length] = '\0';
+    replay->offset += length;
+
+    return value;
+}
+
+static void
+replay_read_header(struct hwd_replay *replay) {
+    replay->has_next = false;
+
+    if (replay->offset >= replay->size) {
+        return;
+    }
+    replay->next_type = replay->data[replay->offset++];
+
+    uint64_t delta_usec;
+    if (!read_uint(replay, &delta_usec)) {
+        wlr_log(WLR_ERROR, "Replay log is truncated");
+        return;
+    }
+    replay->next_time += delta_usec * 1000;
+    replay->has_next = true;
+}
+
+static bool
+replay_load(struct hwd_replay *replay, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        wlr_log_errno(WLR_ERROR, "Unable to open replay %s", path);
+        return false;
+    }
+
+    size_t capacity = 4096;
+    replay->data = malloc(capacity);
+    while (replay->data != NULL) {
+        replay->size += fread(&replay->data[replay->size], 1, capacity - replay->size, file);
+        if (replay->size < capacity) {
+            break;
+        }
+        capacity *= 2;
+        uint8_t *data = realloc(replay->data, capacity);
+        if (data == NULL) {
+            free(replay->data);
+        }
+        replay->data = data;
+    }
+
+    bool ok = replay->data != NULL && !ferror(file);
+    fclose(file);
+    if (!ok) {
+        wlr_log(WLR_ERROR, "Unable to read replay %s", path);
+        return false;
+    }
+
+    if (replay->size < HWD_RECORDER_MAGIC_SIZE ||
+        memcmp(replay->data, HWD_RECORDER_MAGIC, HWD_RECORDER_MAGIC_SIZE) != 0) {
+        wlr_log(WLR_ERROR, "%s is not a hayward recording", path);
+        return false;
+    }
+    replay->offset = HWD_RECORDER_MAGIC_SIZE;
+
+    return true;
+}
+
+static void
+replay_client_send(struct hwd_replay *replay, bool expect_reply, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void
+replay_client_send(struct hwd_replay *replay, bool expect_reply, const char *format, ...) {
+    if (replay->client_in < 0) {
+        return;
+    }
+
+    char line[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0 || (size_t)length >= sizeof(line)) {
+        return;
+    }
+
+    if (write(replay->client_in, line, length) != length) {
+        wlr_log_errno(WLR_ERROR, "Unable to write to replay client");
+        return;
+    }
+
+    if (expect_reply) {
+        replay->num_outstanding++;
+    }
+}
+
+static void
+replay_client_disconnect(struct hwd_replay *replay) {
+    if (replay->client_out_source != NULL) {
+        wl_event_source_remove(replay->client_out_source);
+        replay->client_out_source = NULL;
+    }
+    if (replay->client_out >= 0) {
+        close(replay->client_out);
+        replay->client_out = -1;
+    }
+    if (replay->client_in >= 0) {
+        close(replay->client_in);
+        replay->client_in = -1;
+    }
+    replay->num_outstanding = 0;
+}
+
+static int
+replay_handle_client_out(int fd, uint32_t mask, void *data) {
+    struct hwd_replay *replay = data;
+
+    char buffer[256];
+    ssize_t length = 0;
+    if (mask & WL_EVENT_READABLE) {
+        length = read(fd, buffer, sizeof(buffer));
+    }
+
+    if (length <= 0) {
+        wlr_log(WLR_ERROR, "Replay client stopped responding");
+        replay_client_disconnect(replay);
+        return 0;
+    }
+
+    for (ssize_t i = 0; i < length; i++) {
+        if (buffer[i] == '\n' && replay->num_outstanding > 0) {
+            replay->num_outstanding--;
+        }
+    }
+
+    return 0;
+}
+
+static void
+replay_handle_client_destroy(struct wl_listener *listener, void *data) {
+    struct hwd_replay *replay = wl_container_of(listener, replay, client_destroy);
+
+    wl_list_remove(&replay->client_destroy.link);
+    wl_list_init(&replay->client_destroy.link);
+    replay->client = NULL;
+}
+
+static bool
+replay_spawn_client(struct hwd_replay *replay, const char *client_command) {
+    int sockets[2] = {-1, -1};
+    int in[2] = {-1, -1};
+    int out[2] = {-1, -1};
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0 || pipe(in) != 0 || pipe(out) != 0) {
+        wlr_log_errno(WLR_ERROR, "Unable to create replay client channels");
+        goto failed;
+    }
+    if (!hwd_set_cloexec(sockets[0], true) || !hwd_set_cloexec(sockets[1], true) ||
+        !hwd_set_cloexec(in[1], true) || !hwd_set_cloexec(out[0], true)) {
+        goto failed;
+    }
+
+    replay->client = wl_client_create(server.wl_display, sockets[0]);
+    if (replay->client == NULL) {
+        wlr_log_errno(WLR_ERROR, "wl_client_create failed");
+        goto failed;
+    }
+    sockets[0] = -1;
+
+    replay->client_destroy.notify = replay_handle_client_destroy;
+    wl_client_add_destroy_listener(replay->client, &replay->client_destroy);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        wlr_log_errno(WLR_ERROR, "fork failed");
+        goto failed;
+    } else if (pid == 0) {
+        restore_nofile_limit();
+
+        pid = fork();
+        if (pid < 0) {
+            _exit(EXIT_FAILURE);
+        } else if (pid == 0) {
+            if (!hwd_set_cloexec(sockets[1], false)) {
+                _exit(EXIT_FAILURE);
+            }
+
+            dup2(in[0], STDIN_FILENO);
+            dup2(out[1], STDOUT_FILENO);
+
+            char wayland_socket_str[16];
+            snprintf(wayland_socket_str, sizeof(wayland_socket_str), "%d", sockets[1]);
+            setenv("WAYLAND_SOCKET", wayland_socket_str, true);
+
+            execlp("sh", "sh", "-c", client_command, NULL);
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(sockets[1]);
+    close(in[0]);
+    close(out[1]);
+
+    if (waitpid(pid, NULL, 0) < 0) {
+        wlr_log_errno(WLR_ERROR, "waitpid failed");
+    }
+
+    replay->client_in = in[1];
+    replay->client_out = out[0];
+    replay->client_out_source = wl_event_loop_add_fd(
+        replay->event_loop, replay->client_out, WL_EVENT_READABLE, replay_handle_client_out,
+        replay
+    );
+
+    return true;
+
+failed:
+    for (size_t i = 0; i < 2; i++) {
+        if (sockets[i] >= 0) {
+            close(sockets[i]);
+        }
+        if (in[i] >= 0) {
+            close(in[i]);
+        }
+        if (out[i] >= 0) {
+            close(out[i]);
+        }
+    }
+    return false;
+}
+
+static void
+find_headless_backend(struct wlr_backend *backend, void *data) {
+    struct wlr_backend **headless = data;
+    if (wlr_backend_is_headless(backend)) {
+        *headless = backend;
+    }
+}
+
+static bool
+replay_output_layout(struct hwd_replay *replay) {
+    uint64_t num_outputs;
+    if (!read_uint(replay, &num_outputs)) {
+        return false;
+    }
+
+    struct wlr_backend *headless = NULL;
+    if (wlr_backend_is_multi(server.backend)) {
+        wlr_multi_for_each_backend(server.backend, find_headless_backend, &headless);
+    } else if (wlr_backend_is_headless(server.backend)) {
+        headless = server.backend;
+    }
+
+    // Recorded outputs are matched to current outputs by position in the
+    // layout rather than by name, as names will not match between backends.
+    // Any outputs beyond those in the recording are left as they are.
+    for (uint64_t i = 0; i < num_outputs; i++) {
+        int64_t x, y;
+        uint64_t width, height, scale;
+        if (!read_int(replay, &x) || !read_int(replay, &y) || !read_uint(replay, &width) ||
+            !read_uint(replay, &height) || !read_uint(replay, &scale)) {
+            return false;
+        }
+
+        if (i >= (uint64_t)root->outputs->length) {
+            if (headless == NULL) {
+                wlr_log(WLR_ERROR, "Cannot add outputs to replay without the headless backend");
+                continue;
+            }
+            // Adding an output enables it and appends it to `root->outputs`.
+            wlr_headless_add_output(headless, width, height);
+            if (i >= (uint64_t)root->outputs->length) {
+                wlr_log(WLR_ERROR, "Unable to add headless output for replay");
+                continue;
+            }
+        }
+
+        struct hwd_output *output = root->outputs->items[i];
+        struct wlr_output *wlr_output = output->wlr_output;
+
+        struct wlr_output_state state;
+        wlr_output_state_init(&state);
+        wlr_output_state_set_custom_mode(&state, width, height, 0);
+        wlr_output_state_set_scale(&state, scale / 1000.0f);
+        if (!wlr_output_commit_state(wlr_output, &state)) {
+            wlr_log(WLR_ERROR, "Unable to apply replayed mode to %s", wlr_output->name);
+        }
+        wlr_output_state_finish(&state);
+
+        wlr_output_layout_add(root->output_layout, wlr_output, x, y);
+    }
+
+    return true;
+}
+
+static bool
+replay_command(struct hwd_replay *replay) {
+    char *command = read_string(replay);
+    if (command == NULL) {
+        return false;
+    }
+
+    list_t *res_list = execute_command(command, NULL, NULL);
+    for (int i = 0; i < res_list->length; ++i) {
+        struct cmd_results *res = res_list->items[i];
+        if (res->status != CMD_SUCCESS) {
+            wlr_log(WLR_ERROR, "Error replaying '%s': %s", command, res->error);
+        }
+        free_cmd_results(res);
+    }
+    list_free(res_list);
+    free(command);
+
+    return true;
+}
+
+static bool
+replay_record(struct hwd_replay *replay) {
+    uint64_t window_id;
+    uint64_t latency_usec;
+
+    switch (replay->next_type) {
+    case HWD_RECORDER_COMMAND:
+        return replay_command(replay);
+
+    case HWD_RECORDER_WINDOW_MAP:
+        if (!read_uint(replay, &window_id)) {
+            return false;
+        }
+        replay_client_send(replay, true, "map %llu\n", (unsigned long long)window_id);
+        return true;
+
+    case HWD_RECORDER_WINDOW_UNMAP:
+        if (!read_uint(replay, &window_id)) {
+            return false;
+        }
+        replay_client_send(replay, true, "unmap %llu\n", (unsigned long long)window_id);
+        return true;
+
+    case HWD_RECORDER_WINDOW_CONFIGURE:
+        if (!read_uint(replay, &window_id) || !read_uint(replay, &latency_usec)) {
+            return false;
+        }
+        replay_client_send(
+            replay, false, "ack %llu %llu\n", (unsigned long long)window_id,
+            (unsigned long long)latency_usec
+        );
+        return true;
+
+    case HWD_RECORDER_OUTPUT_LAYOUT:
+        return replay_output_layout(replay);
+    }
+
+    wlr_log(WLR_ERROR, "Unknown record type %d in replay", replay->next_type);
+    return false;
+}
+
+static bool
+replay_is_settled(struct hwd_replay *replay) {
+    struct hwd_transaction_manager *transaction_manager = root_get_transaction_manager(root);
+
+    return replay->num_outstanding == 0 &&
+        transaction_manager->phase == HWD_TRANSACTION_IDLE && !transaction_manager->queued;
+}
+
+static int
+replay_handle_timer(void *data) {
+    HWD_PROFILER_TRACE();
+
+    struct hwd_replay *replay = data;
+
+    while (replay->has_next) {
+        if (replay->fast) {
+            if (!replay_is_settled(replay)) {
+                wl_event_source_timer_update(replay->timer, REPLAY_POLL_MS);
+                return 0;
+            }
+        } else {
+            hwd_timestamp now = hwd_profiler_now();
+            hwd_timestamp due = replay->begin + replay->next_time;
+            if (due > now) {
+                wl_event_source_timer_update(replay->timer, (due - now + 999999) / 1000000);
+                return 0;
+            }
+        }
+
+        if (!replay_record(replay)) {
+            wlr_log(WLR_ERROR, "Replay log is corrupt");
+            replay->has_next = false;
+            break;
+        }
+        replay_read_header(replay);
+    }
+
+    if (!replay_is_settled(replay)) {
+        wl_event_source_timer_update(replay->timer, REPLAY_POLL_MS);
+        return 0;
+    }
+
+    wlr_log(WLR_INFO, "Replay finished");
+
+    return 0;
+}
+
+struct hwd_replay *
+hwd_replay_create(
+    struct wl_event_loop *event_loop, const char *path, const char *client_command, bool fast
+) {
+    struct hwd_replay *replay = calloc(1, sizeof(struct hwd_replay));
+    if (replay == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate replay");
+        return NULL;
+    }
+    replay->event_loop = event_loop;
+    replay->fast = fast;
+    replay->client_in = -1;
+    replay->client_out = -1;
+    wl_list_init(&replay->client_destroy.link);
+
+    if (!replay_load(replay, path)) {
+        hwd_replay_destroy(replay);
+        return NULL;
+    }
+
+    if (client_command == NULL || !replay_spawn_client(replay, client_command)) {
+        wlr_log(WLR_ERROR, "Replaying without a client, windows will not be created");
+    }
+
+    replay->timer = wl_event_loop_add_timer(event_loop, replay_handle_timer, replay);
+    if (replay->timer == NULL) {
+        wlr_log_errno(WLR_ERROR, "Unable to create replay timer");
+        hwd_replay_destroy(replay);
+        return NULL;
+    }
+
+    wlr_log(WLR_INFO, "Replaying %s", path);
+
+    replay->begin = hwd_profiler_now();
+    replay_read_header(replay);
+    wl_event_source_timer_update(replay->timer, 1);
+
+    return replay;
+}
+
+void
+hwd_replay_destroy(struct hwd_replay *replay) {
+    if (replay == NULL) {
+        return;
+    }
+
+    if (replay->timer != NULL) {
+        wl_event_source_remove(replay->timer);
+    }
+
+    replay_client_disconnect(replay);
+
+    wl_list_remove(&replay->client_destroy.link);
+    if (replay->client != NULL) {
+        wl_client_destroy(replay->client);
+    }
+
+    free(replay->data);
+    free(replay);
+}
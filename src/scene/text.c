@@ -25,6 +25,7 @@
 #include <wlr/util/box.h>
 
 #include <hayward/config.h>
+#include <hayward/profiler.h>
 #include <hayward/scene/cairo.h>
 #include <hayward/scene/colours.h>
 
@@ -163,6 +164,8 @@ hwd_text_node_reshape(struct wlr_scene_node *node) {
 
 static void
 hwd_text_node_redraw(struct wlr_scene_node *node) {
+    HWD_PROFILER_TRACE();
+
     struct wlr_scene_buffer *scene_buffer = wlr_scene_buffer_from_node(node);
     struct hwd_text_node_state *state = node->data;
 
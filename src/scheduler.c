@@ -6,6 +6,7 @@
 #include "hayward/scheduler.h"
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <time.h>
@@ -16,7 +17,9 @@
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/util/addon.h>
+#include <wlr/util/log.h>
 
+#include <hayward/latency.h>
 #include <hayward/profiler.h>
 #include <hayward/server.h>
 
@@ -86,7 +89,9 @@ send_frame_done_iterator(struct wlr_scene_buffer *buffer, int x, int y, void *us
     struct send_frame_done_data *data = user_data;
     struct hwd_scene_output_scheduler *scheduler_output = data->scheduler_output;
 
-    if (buffer->primary_output == NULL &&
+    // Buffers that are fully occluded have no primary output.  These are
+    // throttled separately by their shell.
+    if (buffer->primary_output == NULL ||
         buffer->primary_output != scheduler_output->scene_output) {
         return;
     }
@@ -117,7 +122,22 @@ output_repaint_timer_handler(void *data) {
 
     struct hwd_scene_output_scheduler *scheduler_output = data;
 
-    wlr_scene_output_commit(scheduler_output->scene_output, NULL);
+    // Only frames with new content count towards input latency.
+    bool needs_frame = wlr_scene_output_needs_frame(scheduler_output->scene_output);
+
+    hwd_timestamp begin_commit = hwd_profiler_now();
+    bool committed = wlr_scene_output_commit(scheduler_output->scene_output, NULL);
+
+    if (debug.txn_stats && needs_frame) {
+        wlr_log(
+            WLR_INFO, "frame-stats: output=%s duration=%" PRIu64,
+            scheduler_output->scene_output->output->name, hwd_profiler_now() - begin_commit
+        );
+    }
+
+    if (committed && needs_frame) {
+        hwd_latency_output_commit(scheduler_output->latency);
+    }
 
     return 0;
 }
@@ -199,6 +219,9 @@ handle_scene_output_destroy(struct wl_listener *listener, void *data) {
 
     scheduler_output->scene_output = NULL;
 
+    hwd_latency_output_destroy(scheduler_output->latency);
+    scheduler_output->latency = NULL;
+
     wl_event_source_remove(scheduler_output->repaint_timer);
     scheduler_output->repaint_timer = NULL;
 
@@ -212,9 +235,14 @@ handle_output_present(struct wl_listener *listener, void *data) {
     struct wlr_output_event_present *output_event = data;
 
     if (!output_event->presented) {
+        hwd_latency_output_discard(scheduler_output->latency);
         return;
     }
 
+    hwd_latency_output_present(
+        scheduler_output->latency, &output_event->when, output_event->refresh
+    );
+
     scheduler_output->last_presentation = output_event->when;
     scheduler_output->refresh_nsec = output_event->refresh;
 }
@@ -228,6 +256,7 @@ hwd_scene_output_scheduler_create(struct wlr_scene_output *scene_output) {
     assert(scheduler_output != NULL);
 
     scheduler_output->scene_output = scene_output;
+    scheduler_output->latency = hwd_latency_output_create(wlr_output->name);
 
     scheduler_output->scene_output_destroy.notify = handle_scene_output_destroy;
     wl_signal_add(&scene_output->events.destroy, &scheduler_output->scene_output_destroy);
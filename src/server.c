@@ -16,6 +16,7 @@
 #include <wlr/render/wlr_renderer.h>
 #include <wlr/types/wlr_buffer.h>
 #include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_cursor_shape_v1.h>
 #include <wlr/types/wlr_data_control_v1.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_drm.h>
@@ -53,8 +54,11 @@
 #include <hayward/desktop/xwayland.h>
 #include <hayward/globals/root.h>
 #include <hayward/input/input_manager.h>
+#include <hayward/ipc.h>
+#include <hayward/replay.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
+#include <hayward/watchdog.h>
 
 bool
 server_privileged_prepare(struct hwd_server *server) {
@@ -140,6 +144,12 @@ server_init(struct hwd_server *server) {
     server->pointer_constraint.notify = handle_pointer_constraint;
     wl_signal_add(&server->pointer_constraints->events.new_constraint, &server->pointer_constraint);
 
+    server->cursor_shape_manager = wlr_cursor_shape_manager_v1_create(server->wl_display, 1);
+    server->request_set_cursor_shape.notify = handle_request_set_cursor_shape;
+    wl_signal_add(
+        &server->cursor_shape_manager->events.request_set_shape, &server->request_set_cursor_shape
+    );
+
     wlr_presentation_create(server->wl_display, server->backend);
 
     hwd_wlr_output_manager_v1_create(server->wl_display, root->output_layout);
@@ -203,6 +213,8 @@ server_init(struct hwd_server *server) {
 void
 server_fini(struct hwd_server *server) {
     // TODO: free hayward-specific resources
+    hwd_ipc_destroy(server->ipc);
+    server->ipc = NULL;
 #if HAVE_XWAYLAND
     hwd_xwayland_destroy(server->xwayland);
 #endif
@@ -233,11 +245,31 @@ server_start(struct hwd_server *server) {
         return false;
     }
 
+    // Created before any commands are executed so that HAYWARDSOCK is set in
+    // the environment of processes started from the config.
+    server->ipc = hwd_ipc_create(server->wl_event_loop);
+
     return true;
 }
 
 void
 server_run(struct hwd_server *server) {
     wlr_log(WLR_INFO, "Running compositor on wayland display '%s'", server->socket);
+
+    struct hwd_watchdog *watchdog = NULL;
+    if (server->watchdog_timeout_ms > 0) {
+        watchdog = hwd_watchdog_create(server->wl_event_loop, server->watchdog_timeout_ms);
+    }
+
+    struct hwd_replay *replay = NULL;
+    if (server->replay_path != NULL) {
+        replay = hwd_replay_create(
+            server->wl_event_loop, server->replay_path, server->replay_client, server->replay_fast
+        );
+    }
+
     wl_display_run(server->wl_display);
+
+    hwd_replay_destroy(replay);
+    hwd_watchdog_destroy(watchdog);
 }
@@ -6,7 +6,6 @@
 #include "hayward/tree/column.h"
 
 #include <assert.h>
-#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -22,6 +21,7 @@
 #include <hayward/globals/root.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
+#include <hayward/tree/layout.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
 #include <hayward/tree/transaction.h>
@@ -106,12 +106,15 @@ column_destroy(struct hwd_column *column);
 static void
 column_copy_state(struct hwd_column_state *tgt, struct hwd_column_state *src) {
     list_t *tgt_children = tgt->children;
+    size_t tgt_children_generation = tgt->children_generation;
 
     memcpy(tgt, src, sizeof(struct hwd_column_state));
 
     tgt->children = tgt_children;
-    list_clear(tgt->children);
-    list_cat(tgt->children, src->children);
+    if (tgt_children_generation != src->children_generation) {
+        list_clear(tgt->children);
+        list_cat(tgt->children, src->children);
+    }
 }
 
 static void
@@ -272,233 +275,103 @@ column_set_dirty(struct hwd_column *column) {
     hwd_transaction_manager_ensure_queued(transaction_manager);
 }
 
-static void
-column_arrange_split(struct hwd_column *column) {
-    struct hwd_window *child = NULL;
-
-    list_t *children = column->pending.children;
-    list_clear(children);
-    for (int i = 0; i < column->children->length; ++i) {
-        struct hwd_window *window = column->children->items[i];
-        list_add(children, window);
-    }
-
-    struct wlr_box box;
-    column_get_box(column, &box);
-
-    double preview_titlebar_height = 30; // TODO TODO TODO
-
-    double visible_height_fraction = 0.0;
-    double available_content_height = box.height;
-    for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        if (window_is_fullscreen(child)) {
-            continue;
-        }
-        visible_height_fraction += child->height_fraction;
-        available_content_height -= child->pending.titlebar_height;
-    }
-    if (column->pending.show_preview) {
-        visible_height_fraction += column->preview_height_fraction;
-        available_content_height -= preview_titlebar_height;
-    }
-
-    // Distance between top of next window and top of the screen.
-    double y_offset = 0;
-
-    // The distance, in layout coordinates, between the desired location of the
-    // vertical anchor point in the preview and the top of the preview.
-    double preview_baseline = round(column->preview_baseline * column->preview_height_fraction);
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted before this one.
-    double baseline_delta;
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted after this one.
-    double next_baseline_delta;
-
-    bool preview_inserted = false;
-
-    next_baseline_delta = fabs(column->pending.y + preview_baseline - column->preview_anchor_y);
-
-    for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        double window_height = child->pending.titlebar_height;
-        if (window_is_fullscreen(child)) {
-            continue;
-        }
-
-        window_height +=
-            available_content_height * child->height_fraction / visible_height_fraction;
-        child->pending.shaded = false;
-
-        baseline_delta = next_baseline_delta;
-        next_baseline_delta = fabs(
-            column->pending.y + round(y_offset + window_height) + preview_baseline -
-            column->preview_anchor_y
-        );
-        if (column->pending.show_preview && !preview_inserted &&
-            next_baseline_delta > baseline_delta) {
-
-            double preview_height = preview_titlebar_height;
-            preview_height += available_content_height * column->preview_height_fraction /
-                visible_height_fraction;
-
-            column->pending.preview_target = window_get_previous_sibling(child);
-            column->pending.preview_box.x = column->pending.x;
-            column->pending.preview_box.y = column->pending.y + round(y_offset);
-            column->pending.preview_box.width = column->pending.width;
-            column->pending.preview_box.height = round(preview_height);
-
-            preview_inserted = true;
-
-            y_offset += preview_height;
-        }
-
-        child->pending.x = column->pending.x;
-        child->pending.y = column->pending.y + round(y_offset);
-        child->pending.width = box.width;
-        child->pending.height = round(window_height);
-
-        y_offset += child->pending.height;
-    }
-
-    if (column->pending.show_preview && !preview_inserted) {
-        double preview_height = preview_titlebar_height;
-        preview_height +=
-            available_content_height * column->preview_height_fraction / visible_height_fraction;
-
-        column->pending.preview_target = child;
-        column->pending.preview_box.x = column->pending.x;
-        column->pending.preview_box.y = column->pending.y + round(y_offset);
-        column->pending.preview_box.width = column->pending.width;
-        column->pending.preview_box.height = round(preview_height);
-
-        preview_inserted = true;
-
-        y_offset += preview_height;
+struct hwd_column *
+column_from_transaction_commit_listener(struct wl_listener *listener) {
+    if (listener->notify != column_handle_transaction_commit) {
+        return NULL;
     }
 
-    for (int i = 0; i < column->pending.children->length; i++) {
-        struct hwd_window *window = column->pending.children->items[i];
-        window_set_dirty(window);
-    }
+    struct hwd_column *column = wl_container_of(listener, column, transaction_commit);
+    return column;
 }
 
 static void
-column_arrange_stacked(struct hwd_column *column) {
-    struct hwd_window *child = NULL;
-
+column_arrange_children(struct hwd_column *column) {
     list_t *children = column->pending.children;
-    list_clear(children);
+    bool children_changed = false;
     for (int i = 0; i < column->children->length; ++i) {
         struct hwd_window *window = column->children->items[i];
-        list_add(children, window);
+        children_changed |= list_update(children, i, window);
     }
-
-    struct hwd_window *active_child = column->active_child;
-    if (column->pending.show_preview) {
-        active_child = NULL;
+    children_changed |= list_truncate(children, column->children->length);
+    if (children_changed) {
+        column->pending.children_generation++;
     }
 
     struct wlr_box box;
     column_get_box(column, &box);
 
-    double preview_titlebar_height = 30; // TODO TODO TODO
-
-    double available_content_height = box.height;
+    struct hwd_layout_window *layout_windows = NULL;
+    if (children->length > 0) {
+        layout_windows = calloc(children->length, sizeof(struct hwd_layout_window));
+        assert(layout_windows != NULL);
+    }
     for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        if (window_is_fullscreen(child)) {
-            continue;
+        struct hwd_window *child = children->items[i];
+        layout_windows[i].height_fraction = child->height_fraction;
+        layout_windows[i].titlebar_height = child->pending.titlebar_height;
+        layout_windows[i].fullscreen = window_is_fullscreen(child);
+    }
+
+    struct hwd_layout_preview preview = {
+        .show = column->pending.show_preview,
+        .height_fraction = column->preview_height_fraction,
+        .baseline = column->preview_baseline,
+        .anchor_y = column->preview_anchor_y,
+        .titlebar_height = 30, // TODO TODO TODO
+    };
+
+    switch (column->layout) {
+    case L_SPLIT:
+        hwd_layout_arrange_split(
+            column->pending.y, box.height, layout_windows, children->length, &preview
+        );
+        break;
+    case L_STACKED: {
+        size_t active = children->length;
+        if (!column->pending.show_preview) {
+            int index = list_find(children, column->active_child);
+            if (index >= 0) {
+                active = index;
+            }
         }
-        available_content_height -= child->pending.titlebar_height;
+        hwd_layout_arrange_stacked(
+            column->pending.y, box.height, layout_windows, children->length, active, &preview
+        );
+        break;
     }
-    if (column->pending.show_preview) {
-        available_content_height -= preview_titlebar_height;
+    default:
+        assert(false);
+        break;
     }
 
-    // Distance between top of next window and top of the screen.
-    double y_offset = 0;
-
-    // The distance, in layout coordinates, between the desired location of the
-    // vertical anchor point in the preview and the top of the preview.
-    double preview_baseline = round(column->preview_baseline * column->preview_height_fraction);
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted before this one.
-    double baseline_delta;
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted after this one.
-    double next_baseline_delta;
-
-    bool preview_inserted = false;
-
-    next_baseline_delta = fabs(column->pending.y + preview_baseline - column->preview_anchor_y);
-
     for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        if (window_is_fullscreen(child)) {
+        struct hwd_window *child = children->items[i];
+        struct hwd_layout_window *layout_window = &layout_windows[i];
+        if (layout_window->fullscreen) {
             continue;
         }
 
-        double window_height = child->pending.titlebar_height;
-        if (child != active_child) {
-            child->pending.shaded = true;
-        } else {
-            window_height += available_content_height;
-            child->pending.shaded = false;
-        }
-
-        baseline_delta = next_baseline_delta;
-        next_baseline_delta = fabs(
-            column->pending.y + round(y_offset + window_height) + preview_baseline -
-            column->preview_anchor_y
-        );
-        if (column->pending.show_preview && !preview_inserted &&
-            next_baseline_delta > baseline_delta) {
-
-            double preview_height = preview_titlebar_height + available_content_height;
-
-            column->pending.preview_target = window_get_previous_sibling(child);
-            column->pending.preview_box.x = column->pending.x;
-            column->pending.preview_box.y = column->pending.y + round(y_offset);
-            column->pending.preview_box.width = column->pending.width;
-            column->pending.preview_box.height = round(preview_height);
-
-            preview_inserted = true;
-
-            y_offset += preview_height;
-        }
-
         child->pending.x = column->pending.x;
-        child->pending.y = column->pending.y + round(y_offset);
+        child->pending.y = layout_window->y;
         child->pending.width = box.width;
-        child->pending.height = round(window_height);
-
-        y_offset += child->pending.height;
-
-        // TODO Make last visible child use remaining height of parent
+        child->pending.height = layout_window->height;
+        child->pending.shaded = layout_window->shaded;
     }
 
-    if (column->pending.show_preview && !preview_inserted) {
-        double preview_height = preview_titlebar_height + available_content_height;
-
-        column->pending.preview_target = child;
+    if (preview.show) {
+        column->pending.preview_target =
+            preview.index > 0 ? children->items[preview.index - 1] : NULL;
         column->pending.preview_box.x = column->pending.x;
-        column->pending.preview_box.y = column->pending.y + round(y_offset);
+        column->pending.preview_box.y = preview.y;
         column->pending.preview_box.width = column->pending.width;
-        column->pending.preview_box.height = round(preview_height);
-
-        preview_inserted = true;
-
-        y_offset += preview_height;
+        column->pending.preview_box.height = preview.height;
     }
 
-    for (int i = 0; i < column->pending.children->length; i++) {
-        struct hwd_window *window = column->pending.children->items[i];
+    free(layout_windows);
+
+    for (int i = 0; i < children->length; i++) {
+        struct hwd_window *window = children->items[i];
         window_set_dirty(window);
     }
 }
@@ -509,18 +382,7 @@ column_arrange(struct hwd_column *column) {
 
     if (column->dirty) {
         column->pending.dead = column->dead;
-
-        switch (column->layout) {
-        case L_SPLIT:
-            column_arrange_split(column);
-            break;
-        case L_STACKED:
-            column_arrange_stacked(column);
-            break;
-        default:
-            assert(false);
-            break;
-        }
+        column_arrange_children(column);
     }
 
     for (int i = 0; i < column->pending.children->length; i++) {
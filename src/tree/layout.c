@@ -0,0 +1,221 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/tree/layout.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+double
+hwd_layout_arrange_columns(
+    double x, double width, double gap, struct hwd_layout_column *columns, size_t num_columns
+) {
+    if (num_columns == 0) {
+        return width;
+    }
+
+    // Count the number of new columns we are resizing, and how much space is
+    // currently occupied.
+    size_t new_columns = 0;
+    double current_width_fraction = 0;
+    for (size_t i = 0; i < num_columns; i++) {
+        current_width_fraction += columns[i].width_fraction;
+        if (columns[i].width_fraction <= 0) {
+            new_columns += 1;
+        }
+    }
+
+    double total_width_fraction = 0;
+    for (size_t i = 0; i < num_columns; i++) {
+        struct hwd_layout_column *column = &columns[i];
+
+        if (column->width_fraction <= 0) {
+            if (current_width_fraction <= 0) {
+                column->width_fraction = 1.0;
+            } else if (num_columns > new_columns) {
+                column->width_fraction = current_width_fraction / (num_columns - new_columns);
+            } else {
+                column->width_fraction = current_width_fraction;
+            }
+        }
+        total_width_fraction += column->width_fraction;
+    }
+
+    double columns_total_width = width - gap * (num_columns - 1);
+
+    // Normalize width fractions so the sum is 1.0, and resize.
+    double column_x = x;
+    for (size_t i = 0; i < num_columns; i++) {
+        struct hwd_layout_column *column = &columns[i];
+
+        column->width_fraction /= total_width_fraction;
+        column->x = column_x;
+        column->width = round(column->width_fraction * columns_total_width);
+        column_x += column->width + gap;
+    }
+
+    // Make last child use remaining width of parent.
+    struct hwd_layout_column *last = &columns[num_columns - 1];
+    last->width = x + width - last->x;
+
+    return columns_total_width;
+}
+
+static void
+layout_insert_preview(
+    struct hwd_layout_preview *preview, size_t index, double y, double y_offset,
+    double preview_height
+) {
+    preview->index = index;
+    preview->y = y + round(y_offset);
+    preview->height = round(preview_height);
+}
+
+void
+hwd_layout_arrange_split(
+    double y, double height, struct hwd_layout_window *windows, size_t num_windows,
+    struct hwd_layout_preview *preview
+) {
+    double visible_height_fraction = 0.0;
+    double available_content_height = height;
+    for (size_t i = 0; i < num_windows; i++) {
+        struct hwd_layout_window *window = &windows[i];
+        if (window->fullscreen) {
+            continue;
+        }
+        visible_height_fraction += window->height_fraction;
+        available_content_height -= window->titlebar_height;
+    }
+    if (preview->show) {
+        visible_height_fraction += preview->height_fraction;
+        available_content_height -= preview->titlebar_height;
+    }
+
+    // Distance between top of next window and top of the screen.
+    double y_offset = 0;
+
+    // The distance, in layout coordinates, between the desired location of the
+    // vertical anchor point in the preview and the top of the preview.
+    double preview_baseline = round(preview->baseline * preview->height_fraction);
+
+    // Absolute distance between preview baseline and anchor point if preview is
+    // inserted before this one.
+    double baseline_delta;
+
+    // Absolute distance between preview baseline and anchor point if preview is
+    // inserted after this one.
+    double next_baseline_delta = fabs(y + preview_baseline - preview->anchor_y);
+
+    bool preview_inserted = false;
+
+    double preview_height = preview->titlebar_height;
+    if (preview->show) {
+        preview_height +=
+            available_content_height * preview->height_fraction / visible_height_fraction;
+    }
+
+    for (size_t i = 0; i < num_windows; i++) {
+        struct hwd_layout_window *window = &windows[i];
+        if (window->fullscreen) {
+            continue;
+        }
+
+        double window_height = window->titlebar_height;
+        window_height +=
+            available_content_height * window->height_fraction / visible_height_fraction;
+        window->shaded = false;
+
+        baseline_delta = next_baseline_delta;
+        next_baseline_delta =
+            fabs(y + round(y_offset + window_height) + preview_baseline - preview->anchor_y);
+        if (preview->show && !preview_inserted && next_baseline_delta > baseline_delta) {
+            layout_insert_preview(preview, i, y, y_offset, preview_height);
+            preview_inserted = true;
+            y_offset += preview_height;
+        }
+
+        window->y = y + round(y_offset);
+        window->height = round(window_height);
+
+        y_offset += window->height;
+    }
+
+    if (preview->show && !preview_inserted) {
+        layout_insert_preview(preview, num_windows, y, y_offset, preview_height);
+    }
+}
+
+void
+hwd_layout_arrange_stacked(
+    double y, double height, struct hwd_layout_window *windows, size_t num_windows,
+    size_t active, struct hwd_layout_preview *preview
+) {
+    double available_content_height = height;
+    for (size_t i = 0; i < num_windows; i++) {
+        struct hwd_layout_window *window = &windows[i];
+        if (window->fullscreen) {
+            continue;
+        }
+        available_content_height -= window->titlebar_height;
+    }
+    if (preview->show) {
+        available_content_height -= preview->titlebar_height;
+    }
+
+    // Distance between top of next window and top of the screen.
+    double y_offset = 0;
+
+    // The distance, in layout coordinates, between the desired location of the
+    // vertical anchor point in the preview and the top of the preview.
+    double preview_baseline = round(preview->baseline * preview->height_fraction);
+
+    // Absolute distance between preview baseline and anchor point if preview is
+    // inserted before this one.
+    double baseline_delta;
+
+    // Absolute distance between preview baseline and anchor point if preview is
+    // inserted after this one.
+    double next_baseline_delta = fabs(y + preview_baseline - preview->anchor_y);
+
+    bool preview_inserted = false;
+
+    double preview_height = preview->titlebar_height + available_content_height;
+
+    for (size_t i = 0; i < num_windows; i++) {
+        struct hwd_layout_window *window = &windows[i];
+        if (window->fullscreen) {
+            continue;
+        }
+
+        double window_height = window->titlebar_height;
+        if (i != active) {
+            window->shaded = true;
+        } else {
+            window_height += available_content_height;
+            window->shaded = false;
+        }
+
+        baseline_delta = next_baseline_delta;
+        next_baseline_delta =
+            fabs(y + round(y_offset + window_height) + preview_baseline - preview->anchor_y);
+        if (preview->show && !preview_inserted && next_baseline_delta > baseline_delta) {
+            layout_insert_preview(preview, i, y, y_offset, preview_height);
+            preview_inserted = true;
+            y_offset += preview_height;
+        }
+
+        window->y = y + round(y_offset);
+        window->height = round(window_height);
+
+        y_offset += window->height;
+
+        // TODO Make last visible child use remaining height of parent
+    }
+
+    if (preview->show && !preview_inserted) {
+        layout_insert_preview(preview, num_windows, y, y_offset, preview_height);
+    }
+}
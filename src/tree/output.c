@@ -31,7 +31,6 @@
 #include <hayward/profiler.h>
 #include <hayward/scheduler.h>
 #include <hayward/server.h>
-#include <hayward/tree/column.h>
 #include <hayward/tree/root.h>
 #include <hayward/tree/transaction.h>
 #include <hayward/tree/window.h>
@@ -136,6 +135,7 @@ output_create(struct wlr_output *wlr_output) {
     output->scale_filter = SCALE_FILTER_NEAREST;
 
     output->fullscreen_windows = create_list();
+    output->windows = create_list();
 
     output_init_scene(output);
 
@@ -179,29 +179,21 @@ output_enable(struct hwd_output *output) {
 
 static void
 output_evacuate(struct hwd_output *output) {
-    for (int i = 0; i < output->fullscreen_windows->length; i++) {
-        struct hwd_window *window = output->fullscreen_windows->items[i];
-        window_evacuate(window, output);
-    }
+    // Evacuating a window removes it from `output->windows`, so work from a
+    // copy.
+    list_t *windows = create_list();
+    list_cat(windows, output->windows);
 
-    for (int i = 0; i < root->workspaces->length; i++) {
-        struct hwd_workspace *workspace = root->workspaces->items[i];
-
-        for (int j = 0; j < workspace->columns->length; j++) {
-            struct hwd_column *column = workspace->columns->items[j];
-            for (int k = 0; k < column->children->length; k++) {
-                struct hwd_window *window = column->children->items[k];
-                window_evacuate(window, output);
-            }
-        }
+    for (int i = 0; i < windows->length; i++) {
+        struct hwd_window *window = windows->items[i];
+        window_evacuate(window, output);
 
-        for (int j = 0; j < workspace->floating->length; j++) {
-            struct hwd_window *window = workspace->floating->items[j];
-            window_evacuate(window, output);
+        if (window->workspace != NULL) {
+            workspace_set_dirty(window->workspace);
         }
-
-        workspace_set_dirty(workspace);
     }
+
+    list_free(windows);
 }
 
 static void
@@ -211,6 +203,7 @@ output_destroy(struct hwd_output *output) {
     assert(!output->dirty);
 
     list_free(output->fullscreen_windows);
+    list_free(output->windows);
 
     output_destroy_scene(output);
 
@@ -227,6 +220,10 @@ output_disable(struct hwd_output *output) {
     wlr_log(WLR_DEBUG, "Disabling output '%s'", output->wlr_output->name);
     wl_signal_emit_mutable(&output->events.disable, output);
 
+    // Layer surfaces are destroyed with the output.  Make sure that the usable
+    // area is recalculated if it is enabled again.
+    output->layers_area = (struct wlr_box){0};
+
     output_evacuate(output);
 
     list_del(root->outputs, index);
@@ -296,12 +293,40 @@ output_set_dirty(struct hwd_output *output) {
     hwd_transaction_manager_ensure_queued(transaction_manager);
 }
 
+struct hwd_output *
+output_from_transaction_commit_listener(struct wl_listener *listener) {
+    if (listener->notify != output_handle_transaction_commit) {
+        return NULL;
+    }
+
+    struct hwd_output *output = wl_container_of(listener, output, transaction_commit);
+    return output;
+}
+
 void
 output_reconcile(struct hwd_output *output) {
     assert(output != NULL);
     output_set_dirty(output);
 }
 
+void
+output_arrange_layers(struct hwd_output *output) {
+    if (!output->dirty || output->dead) {
+        return;
+    }
+
+    // Layer surfaces rearrange their output themselves when their placement
+    // changes, so here they only need to be rearranged if the output was
+    // resized.
+    struct wlr_box full_area = {0};
+    wlr_output_effective_resolution(output->wlr_output, &full_area.width, &full_area.height);
+    if (wlr_box_equal(&full_area, &output->layers_area)) {
+        return;
+    }
+
+    arrange_layers(output);
+}
+
 void
 output_arrange(struct hwd_output *output) {
     HWD_PROFILER_TRACE();
@@ -336,8 +361,6 @@ output_arrange(struct hwd_output *output) {
 
             break;
         }
-
-        arrange_layers(output);
     }
 
     if (output->pending.fullscreen_window) {
@@ -28,8 +28,10 @@
 #include <hayward/config.h>
 #include <hayward/desktop/hwd_workspace_management_v1.h>
 #include <hayward/desktop/idle_inhibit_v1.h>
+#include <hayward/latency.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
+#include <hayward/recorder.h>
 #include <hayward/server.h>
 #include <hayward/theme.h>
 #include <hayward/tree/column.h>
@@ -54,7 +56,7 @@ struct hwd_pid_workspace {
 };
 
 static void
-root_validate(struct hwd_root *root);
+root_validate(struct hwd_root *root, bool full);
 
 static void
 root_init_scene(struct hwd_root *root) {
@@ -126,7 +128,7 @@ root_handle_transaction_before_commit(struct wl_listener *listener, void *data)
 #ifndef NDEBUG
     assert(root->focused_surface == root_get_focused_surface(root));
 
-    root_validate(root);
+    root_validate(root, debug.validate);
 #endif
 }
 
@@ -159,6 +161,10 @@ root_handle_transaction_apply(struct wl_listener *listener, void *data) {
         root->orphaned_theme = root->committed.theme;
     }
 
+    if (root->current.workspace != root->committed.workspace) {
+        hwd_latency_notify_workspace_switch_applied();
+    }
+
     root_copy_state(&root->current, &root->committed);
 }
 
@@ -171,6 +177,8 @@ root_handle_transaction_after_apply(struct wl_listener *listener, void *data) {
         root->orphaned_theme = NULL;
     }
 
+    hwd_workspace_manager_v1_flush(root->workspace_manager);
+
     wl_signal_emit_mutable(&root->events.scene_changed, root);
 }
 
@@ -178,6 +186,9 @@ static void
 root_handle_output_layout_change(struct wl_listener *listener, void *data) {
     struct hwd_root *root = wl_container_of(listener, root, output_layout_change);
 
+    hwd_recorder_output_layout(root->output_layout);
+
+    root->hidden_workspaces_dirty = true;
     root_set_dirty(root);
 }
 
@@ -283,6 +294,13 @@ root_arrange(struct hwd_root *root) {
         }
     }
 
+    // Layers are arranged first so that changes to the usable area of an
+    // output are picked up by workspaces in the same transaction.
+    for (int i = 0; i < root->pending.outputs->length; i++) {
+        struct hwd_output *output = root->pending.outputs->items[i];
+        output_arrange_layers(output);
+    }
+
     if (root->pending.workspace != NULL) {
         workspace_arrange(root->pending.workspace);
     }
@@ -291,6 +309,36 @@ root_arrange(struct hwd_root *root) {
         struct hwd_output *output = root->pending.outputs->items[i];
         output_arrange(output);
     }
+
+    // Inactive workspaces are arranged after outputs so that they pick up the
+    // new usable areas.  Their windows will be resized in the background so
+    // that they are ready by the time the workspace is switched to.
+    if (root->hidden_workspaces_dirty) {
+        root->hidden_workspaces_dirty = false;
+
+        for (int i = 0; i < root->workspaces->length; i++) {
+            struct hwd_workspace *workspace = root->workspaces->items[i];
+            if (workspace == root->pending.workspace) {
+                continue;
+            }
+
+            workspace_set_dirty(workspace);
+            workspace_arrange(workspace);
+        }
+    }
+}
+
+static void
+set_workspace_windows_dirty(struct hwd_workspace *workspace) {
+    for (int i = 0; i < workspace->pending.columns->length; i++) {
+        struct hwd_column *column = workspace->pending.columns->items[i];
+        for (int j = 0; j < column->pending.children->length; j++) {
+            window_set_dirty(column->pending.children->items[j]);
+        }
+    }
+    for (int i = 0; i < workspace->pending.floating->length; i++) {
+        window_set_dirty(workspace->pending.floating->items[i]);
+    }
 }
 
 void
@@ -305,7 +353,12 @@ root_set_active_workspace(struct hwd_root *root, struct hwd_workspace *workspace
 
     root->active_workspace = workspace;
 
+    hwd_latency_notify_workspace_switch();
+
     if (old_workspace != NULL) {
+        // Windows on the old workspace will not be arranged, but still need to
+        // be committed so that views can react to being hidden.
+        set_workspace_windows_dirty(old_workspace);
         workspace_consider_destroy(old_workspace);
         workspace_set_dirty(old_workspace);
     }
@@ -621,9 +674,6 @@ column_validate(struct hwd_column *column) {
 
         // TODO validate that no columns on this output reference the window.
         assert(window->fullscreen || window->column != column || window->output == column->output);
-
-        // TODO should only be called once per window.
-        window_validate(window);
     }
 }
 
@@ -634,30 +684,11 @@ output_validate(struct hwd_output *output) {
     for (int i = 0; i < output->fullscreen_windows->length; i++) {
         struct hwd_window *window = output->fullscreen_windows->items[i];
         assert(window->fullscreen);
-
-        // TODO should only be called once per window.
-        window_validate(window);
     }
 }
 
 static void
-root_validate(struct hwd_root *root) {
-    assert(root != NULL);
-
-    // Validate that there is at least one workspace.
-    struct hwd_workspace *active_workspace = root->active_workspace;
-    assert(active_workspace != NULL);
-    assert(list_find(root->workspaces, active_workspace) != -1);
-
-    // Validate that the correct output is focused if workspace is in tiling
-    // mode.
-    if (active_workspace->focus_mode == F_TILING) {
-        if (active_workspace->active_column) {
-            assert(root->active_output == active_workspace->active_column->output);
-        }
-    }
-
-    // Recursively validate each workspace.
+root_validate_full(struct hwd_root *root) {
     for (int i = 0; i < root->workspaces->length; i++) {
         struct hwd_workspace *workspace = root->workspaces->items[i];
         assert(workspace != NULL);
@@ -665,20 +696,92 @@ root_validate(struct hwd_root *root) {
         // Validate floating windows.
         for (int j = 0; j < workspace->floating->length; j++) {
             struct hwd_window *window = workspace->floating->items[j];
-
-            // TODO should only be called once per window.
             window_validate(window);
         }
 
         for (int j = 0; j < workspace->columns->length; j++) {
             struct hwd_column *column = workspace->columns->items[j];
             column_validate(column);
+
+            for (int k = 0; k < column->children->length; k++) {
+                struct hwd_window *window = column->children->items[k];
+                window_validate(window);
+            }
         }
     }
 
     for (int i = 0; i < root->outputs->length; i++) {
         struct hwd_output *output = root->outputs->items[i];
         output_validate(output);
+
+        for (int j = 0; j < output->fullscreen_windows->length; j++) {
+            struct hwd_window *window = output->fullscreen_windows->items[j];
+            // TODO should only be called once per window.
+            window_validate(window);
+        }
+    }
+}
+
+static void
+root_validate_dirty(struct hwd_root *root) {
+    // Every dirty node is listening for the commit event of the transaction
+    // that is about to be committed.
+    struct wl_listener *listener;
+    wl_list_for_each(listener, &root->transaction_manager->events.commit.listener_list, link) {
+        struct hwd_window *window = window_from_transaction_commit_listener(listener);
+        if (window != NULL) {
+            // Dead and detached windows are not part of the tree.
+            if (window->workspace != NULL) {
+                window_validate(window);
+            }
+            continue;
+        }
+
+        struct hwd_column *column = column_from_transaction_commit_listener(listener);
+        if (column != NULL) {
+            if (column->workspace != NULL) {
+                column_validate(column);
+            }
+            continue;
+        }
+
+        struct hwd_output *output = output_from_transaction_commit_listener(listener);
+        if (output != NULL) {
+            if (output->enabled) {
+                output_validate(output);
+            }
+            continue;
+        }
+    }
+}
+
+/*
+ * Checks tree invariants.  Unless `full` is set, only nodes that have been
+ * marked dirty in the current transaction are checked.  Clean nodes were
+ * checked when they were last committed, and anything that could invalidate
+ * them should have marked them dirty.
+ */
+static void
+root_validate(struct hwd_root *root, bool full) {
+    assert(root != NULL);
+
+    // Validate that there is at least one workspace.
+    struct hwd_workspace *active_workspace = root->active_workspace;
+    assert(active_workspace != NULL);
+    assert(list_find(root->workspaces, active_workspace) != -1);
+
+    // Validate that the correct output is focused if workspace is in tiling
+    // mode.
+    if (active_workspace->focus_mode == F_TILING) {
+        if (active_workspace->active_column) {
+            assert(root->active_output == active_workspace->active_column->output);
+        }
+    }
+
+    if (full) {
+        root_validate_full(root);
+    } else {
+        root_validate_dirty(root);
     }
 }
 
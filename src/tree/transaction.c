@@ -7,7 +7,9 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -57,6 +59,8 @@ hwd_transaction_manager_destroy(struct hwd_transaction_manager *transaction_mana
 
 static void
 transaction_progress(struct hwd_transaction_manager *transaction_manager) {
+    HWD_PROFILER_TRACE();
+
     assert(transaction_manager != NULL);
     assert(transaction_manager->phase == HWD_TRANSACTION_WAITING_CONFIRM);
 
@@ -69,6 +73,7 @@ transaction_progress(struct hwd_transaction_manager *transaction_manager) {
 
     wlr_log(WLR_DEBUG, "Applying transaction");
 
+    size_t num_configures = transaction_manager->num_configures;
     transaction_manager->num_configures = 0;
 
     transaction_manager->phase = HWD_TRANSACTION_APPLY;
@@ -81,7 +86,20 @@ transaction_progress(struct hwd_transaction_manager *transaction_manager) {
     wl_signal_emit_mutable(&transaction_manager->events.after_apply, NULL);
     hwd_profiler_mark("transaction after apply", begin_after_apply, hwd_profiler_now());
 
-    hwd_profiler_mark("transaction", transaction_manager->begin_transaction, hwd_profiler_now());
+    hwd_timestamp end_transaction = hwd_profiler_now();
+    hwd_profiler_mark("transaction", transaction_manager->begin_transaction, end_transaction);
+
+    if (debug.txn_stats) {
+        wlr_log(
+            WLR_INFO,
+            "txn-stats: before_commit=%" PRIu64 " commit=%" PRIu64 " confirm=%" PRIu64
+            " apply=%" PRIu64 " total=%" PRIu64 " configures=%zu allocations=%zu",
+            transaction_manager->before_commit_duration, transaction_manager->commit_duration,
+            begin_apply - transaction_manager->begin_waiting_confirm, end_transaction - begin_apply,
+            end_transaction - transaction_manager->begin_transaction, num_configures,
+            hwd_profiler_allocation_count() - transaction_manager->begin_allocations
+        );
+    }
 
     transaction_manager->phase = HWD_TRANSACTION_IDLE;
 
@@ -93,6 +111,8 @@ transaction_progress(struct hwd_transaction_manager *transaction_manager) {
 
 static void
 handle_commit(void *data) {
+    HWD_PROFILER_TRACE();
+
     struct hwd_transaction_manager *transaction_manager = data;
 
     transaction_manager->idle = NULL;
@@ -100,6 +120,9 @@ handle_commit(void *data) {
     assert(transaction_manager->depth == 0);
 
     transaction_manager->begin_transaction = hwd_profiler_now();
+    if (debug.txn_stats) {
+        transaction_manager->begin_allocations = hwd_profiler_allocation_count();
+    }
 
     transaction_manager->phase = HWD_TRANSACTION_BEFORE_COMMIT;
     hwd_timestamp begin_before_commit = hwd_profiler_now();
@@ -107,14 +130,18 @@ handle_commit(void *data) {
     wl_signal_emit_mutable(&transaction_manager->events.before_commit, NULL);
     transaction_manager->queued = false;
 
-    hwd_profiler_mark("transaction before commit", begin_before_commit, hwd_profiler_now());
+    hwd_timestamp end_before_commit = hwd_profiler_now();
+    hwd_profiler_mark("transaction before commit", begin_before_commit, end_before_commit);
+    transaction_manager->before_commit_duration = end_before_commit - begin_before_commit;
 
     transaction_manager->phase = HWD_TRANSACTION_COMMIT;
     hwd_timestamp begin_commit = hwd_profiler_now();
 
     wl_signal_emit_mutable(&transaction_manager->events.commit, NULL);
 
-    hwd_profiler_mark("transaction commit", begin_commit, hwd_profiler_now());
+    hwd_timestamp end_commit = hwd_profiler_now();
+    hwd_profiler_mark("transaction commit", begin_commit, end_commit);
+    transaction_manager->commit_duration = end_commit - begin_commit;
 
     transaction_manager->phase = HWD_TRANSACTION_WAITING_CONFIRM;
     transaction_manager->begin_waiting_confirm = hwd_profiler_now();
@@ -29,6 +29,7 @@
 #include <hayward/input/seat.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
+#include <hayward/recorder.h>
 #include <hayward/scene/colours.h>
 #include <hayward/scene/nineslice.h>
 #include <hayward/scene/text.h>
@@ -119,8 +120,8 @@ window_init_scene(struct hwd_window *window) {
 
     window->layers.titlebar_button_close = &wlr_scene_buffer_create(scene_tree, NULL)->node;
 
-    window->layers.border = hwd_nineslice_node_create(scene_tree, NULL, 0, 0, 0, 0);
-    assert(window->layers.border != NULL);
+    // The border is created on demand by `window_update_scene`.
+    window->layers.border = NULL;
 
     window->layers.content_tree = wlr_scene_tree_create(scene_tree);
     assert(window->layers.content_tree != NULL);
@@ -173,8 +174,25 @@ window_update_scene(struct hwd_window *window) {
         theme->titlebar_v_padding
     );
 
+    // Shaded windows only show their titlebar.  Release the border and leave
+    // the content where it is until the window is expanded again.
+    wlr_scene_node_set_enabled(&window->layers.content_tree->node, !shaded);
+    if (shaded) {
+        if (window->layers.border != NULL) {
+            wlr_scene_node_destroy(window->layers.border);
+            window->layers.border = NULL;
+        }
+        return;
+    }
+
     // Border.
-    wlr_scene_node_set_enabled(window->layers.border, !fullscreen && !shaded);
+    if (window->layers.border == NULL) {
+        window->layers.border =
+            hwd_nineslice_node_create(window->layers.inner_tree, NULL, 0, 0, 0, 0);
+        assert(window->layers.border != NULL);
+        wlr_scene_node_place_below(window->layers.border, &window->layers.content_tree->node);
+    }
+    wlr_scene_node_set_enabled(window->layers.border, !fullscreen);
     hwd_nineslice_node_update(
         window->layers.border, theme->border.buffer, theme->border.left_break,
         theme->border.right_break, theme->border.top_break, theme->border.bottom_break
@@ -183,7 +201,6 @@ window_update_scene(struct hwd_window *window) {
     hwd_nineslice_node_set_size(window->layers.border, width, height - titlebar_height);
 
     // Content.
-    wlr_scene_node_set_enabled(&window->layers.content_tree->node, !shaded);
     wlr_scene_node_set_position(
         &window->layers.content_tree->node, fullscreen ? 0 : border_left,
         fullscreen ? 0 : titlebar_height + border_top
@@ -234,6 +251,7 @@ window_begin_configure(struct hwd_window *window) {
     hwd_transaction_manager_acquire_commit_lock(transaction_manager);
 
     window->is_configuring = true;
+    window->begin_configure = hwd_profiler_now();
 }
 
 void
@@ -243,6 +261,8 @@ window_end_configure(struct hwd_window *window) {
     }
     window->is_configuring = false;
 
+    hwd_recorder_window_configure(window->id, hwd_profiler_now() - window->begin_configure);
+
     struct hwd_transaction_manager *transaction_manager =
         root_get_transaction_manager(window->root);
     hwd_transaction_manager_release_commit_lock(transaction_manager);
@@ -338,6 +358,8 @@ window_create(struct hwd_root *root, struct hwd_view *view) {
 
     window_set_dirty(window);
 
+    hwd_recorder_window_map(window->id);
+
     return window;
 }
 
@@ -360,6 +382,8 @@ window_begin_destroy(struct hwd_window *window) {
     assert(window != NULL);
     assert(window_is_alive(window));
 
+    hwd_recorder_window_unmap(window->id);
+
     window_end_mouse_operation(window);
 
     window_detach(window);
@@ -373,6 +397,12 @@ window_begin_destroy(struct hwd_window *window) {
     }
     list_free(window->output_history);
 
+    // The output pointer is kept so that the window can still be arranged
+    // while it is being destroyed, but it should no longer be evacuated.
+    if (window->output != NULL) {
+        list_remove(window->output->windows, window);
+    }
+
     if (window->urgent_timer) {
         wl_event_source_remove(window->urgent_timer);
         window->urgent_timer = NULL;
@@ -404,6 +434,16 @@ window_set_dirty(struct hwd_window *window) {
     hwd_transaction_manager_ensure_queued(transaction_manager);
 }
 
+struct hwd_window *
+window_from_transaction_commit_listener(struct wl_listener *listener) {
+    if (listener->notify != window_handle_transaction_commit) {
+        return NULL;
+    }
+
+    struct hwd_window *window = wl_container_of(listener, window, transaction_commit);
+    return window;
+}
+
 void
 window_detach(struct hwd_window *window) {
     struct hwd_column *column = window->column;
@@ -530,7 +570,7 @@ window_reconcile_tiling(struct hwd_window *window, struct hwd_column *column) {
 
     list_clear(window->output_history);
     list_add(window->output_history, column->output);
-    window->output = column->output;
+    window_set_output(window, column->output);
 
     window_set_dirty(window);
 }
@@ -694,7 +734,7 @@ window_evacuate(struct hwd_window *window, struct hwd_output *old_output) {
         }
     }
 
-    window->output = new_output;
+    window_set_output(window, new_output);
     window_set_dirty(window);
     output_set_dirty(new_output);
 }
@@ -981,7 +1021,7 @@ window_fullscreen_on_output(struct hwd_window *window, struct hwd_output *output
         int current_output_index = list_find(window->output_history, current_output);
         assert(current_output_index != -1);
         list_insert(window->output_history, current_output_index, output);
-        window->output = output;
+        window_set_output(window, output);
     }
 
     list_add(output->fullscreen_windows, window);
@@ -1010,7 +1050,7 @@ window_unfullscreen(struct hwd_window *window) {
             list_remove(window->output_history, window->column->output);
             int current_output_index = list_find(window->output_history, window->output);
             list_insert(window->output_history, current_output_index, window->column->output);
-            window->output = window->column->output;
+            window_set_output(window, window->column->output);
         }
 
         if (!window->column->output->enabled) {
@@ -1097,6 +1137,25 @@ window_floating_move_to(
     window_set_dirty(window);
 }
 
+void
+window_set_output(struct hwd_window *window, struct hwd_output *output) {
+    assert(window != NULL);
+
+    if (window->output == output) {
+        return;
+    }
+
+    if (window->output != NULL) {
+        list_remove(window->output->windows, window);
+    }
+
+    window->output = output;
+
+    if (output != NULL) {
+        list_add(output->windows, window);
+    }
+}
+
 struct hwd_output *
 window_get_output(struct hwd_window *window) {
     assert(window != NULL);
@@ -7,7 +7,6 @@
 
 #include <assert.h>
 #include <ctype.h>
-#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -28,6 +27,7 @@
 #include <hayward/scene/nineslice.h>
 #include <hayward/theme.h>
 #include <hayward/tree/column.h>
+#include <hayward/tree/layout.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
 #include <hayward/tree/transaction.h>
@@ -199,17 +199,23 @@ workspace_destroy_scene(struct hwd_workspace *workspace) {
 static void
 workspace_copy_state(struct hwd_workspace_state *tgt, struct hwd_workspace_state *src) {
     list_t *tgt_floating = tgt->floating;
+    size_t tgt_floating_generation = tgt->floating_generation;
     list_t *tgt_columns = tgt->columns;
+    size_t tgt_columns_generation = tgt->columns_generation;
 
     memcpy(tgt, src, sizeof(struct hwd_workspace_state));
 
     tgt->floating = tgt_floating;
-    list_clear(tgt->floating);
-    list_cat(tgt->floating, src->floating);
+    if (tgt_floating_generation != src->floating_generation) {
+        list_clear(tgt->floating);
+        list_cat(tgt->floating, src->floating);
+    }
 
     tgt->columns = tgt_columns;
-    list_clear(tgt->columns);
-    list_cat(tgt->columns, src->columns);
+    if (tgt_columns_generation != src->columns_generation) {
+        list_clear(tgt->columns);
+        list_cat(tgt->columns, src->columns);
+    }
 }
 
 static void
@@ -358,6 +364,8 @@ workspace_destroy(struct hwd_workspace *workspace) {
     list_free(workspace->committed.columns);
     list_free(workspace->current.floating);
     list_free(workspace->current.columns);
+    free(workspace->arrange_columns);
+    free(workspace->arrange_layout_columns);
     free(workspace);
 }
 
@@ -422,7 +430,9 @@ workspace_by_name(const char *name) {
 
 static void
 arrange_floating(struct hwd_workspace *workspace) {
-    list_clear(workspace->pending.floating);
+    list_t *floating = workspace->pending.floating;
+    bool floating_changed = false;
+    int floating_length = 0;
 
     for (int i = 0; i < workspace->floating->length; ++i) {
         struct hwd_window *window = workspace->floating->items[i];
@@ -435,10 +445,36 @@ arrange_floating(struct hwd_workspace *workspace) {
 
         window->pending.shaded = false;
 
-        list_add(workspace->pending.floating, window);
+        floating_changed |= list_update(floating, floating_length++, window);
 
         window_set_dirty(window);
     }
+
+    floating_changed |= list_truncate(floating, floating_length);
+    if (floating_changed) {
+        workspace->pending.floating_generation++;
+    }
+}
+
+static void
+workspace_reserve_arrange_scratch(struct hwd_workspace *workspace, size_t length) {
+    if (length <= workspace->arrange_capacity) {
+        return;
+    }
+
+    size_t capacity = workspace->arrange_capacity ? workspace->arrange_capacity : 8;
+    while (capacity < length) {
+        capacity *= 2;
+    }
+
+    workspace->arrange_columns =
+        realloc(workspace->arrange_columns, capacity * sizeof(struct hwd_column *));
+    workspace->arrange_layout_columns =
+        realloc(workspace->arrange_layout_columns, capacity * sizeof(struct hwd_layout_column));
+    assert(workspace->arrange_columns != NULL);
+    assert(workspace->arrange_layout_columns != NULL);
+
+    workspace->arrange_capacity = capacity;
 }
 
 static void
@@ -447,106 +483,92 @@ arrange_tiling(struct hwd_workspace *workspace) {
     int gap = hwd_theme_get_column_separator_width(theme);
 
     list_t *columns = workspace->pending.columns;
-    list_clear(columns);
+    bool columns_changed = false;
+    int columns_length = 0;
     for (int i = 0; i < workspace->columns->length; ++i) {
         struct hwd_column *column = workspace->columns->items[i];
 
         // TODO filter hidden columns.
-        list_add(columns, column);
+        columns_changed |= list_update(columns, columns_length++, column);
+    }
+    columns_changed |= list_truncate(columns, columns_length);
+    if (columns_changed) {
+        workspace->pending.columns_generation++;
     }
 
     if (!columns->length) {
         return;
     }
 
-    for (int i = 0; i < root->outputs->length; ++i) {
-        struct hwd_output *output = root->outputs->items[i];
-
-        struct wlr_box box;
-        output_get_usable_area(output, &box);
-
-        // Count the number of new columns we are resizing, and how much space
-        // is currently occupied.
-        int new_columns = 0;
-        int total_columns = 0;
-        double current_width_fraction = 0;
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            if (column->output != output) {
-                continue;
-            }
+    // Group columns by output, preserving their order within each output.
+    // Each output records where its columns start in the scratch arrays, so
+    // grouping is linear in the number of columns.  Outputs are arranged in
+    // the order of `root->outputs`.  Columns on outputs that have been
+    // disabled are left where they are.
+    workspace_reserve_arrange_scratch(workspace, columns->length);
+    struct hwd_column **grouped_columns = workspace->arrange_columns;
+    struct hwd_layout_column *layout_columns = workspace->arrange_layout_columns;
+
+    list_t *outputs = root->outputs;
+    for (int i = 0; i < outputs->length; i++) {
+        struct hwd_output *output = outputs->items[i];
+        output->arrange_length = 0;
+    }
 
-            current_width_fraction += column->width_fraction;
-            if (column->width_fraction <= 0) {
-                new_columns += 1;
-            }
-            total_columns += 1;
+    for (int i = 0; i < columns->length; i++) {
+        struct hwd_column *column = columns->items[i];
+        if (column->output != NULL && column->output->enabled) {
+            column->output->arrange_length++;
         }
+    }
 
-        // Scan for first column, last column, and total width fraction for this
-        // output.
-        struct hwd_column *first_column = NULL;
-        struct hwd_column *last_column = NULL;
-        double total_width_fraction = 0;
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            if (column->output != output) {
-                continue;
-            }
+    size_t offset = 0;
+    for (int i = 0; i < outputs->length; i++) {
+        struct hwd_output *output = outputs->items[i];
+        output->arrange_start = offset;
+        offset += output->arrange_length;
+        output->arrange_length = 0;
+    }
 
-            if (first_column == NULL) {
-                first_column = column;
-            }
-            last_column = column;
-
-            if (column->width_fraction <= 0) {
-                if (current_width_fraction <= 0) {
-                    column->width_fraction = 1.0;
-                } else if (total_columns > new_columns) {
-                    column->width_fraction = current_width_fraction / (total_columns - new_columns);
-                } else {
-                    column->width_fraction = current_width_fraction;
-                }
-            }
-            total_width_fraction += column->width_fraction;
+    for (int i = 0; i < columns->length; i++) {
+        struct hwd_column *column = columns->items[i];
+        struct hwd_output *output = column->output;
+        if (output == NULL || !output->enabled) {
+            continue;
         }
 
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            column->pending.is_first_child = column == first_column;
-            column->pending.is_last_child = column == last_column;
-        }
+        size_t index = output->arrange_start + output->arrange_length++;
+        grouped_columns[index] = column;
+        layout_columns[index] = (struct hwd_layout_column){
+            .width_fraction = column->width_fraction,
+        };
+    }
 
-        // Normalize width fractions so the sum is 1.0.
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            if (column->output != output) {
-                continue;
-            }
-            column->width_fraction /= total_width_fraction;
+    for (int i = 0; i < outputs->length; i++) {
+        struct hwd_output *output = outputs->items[i];
+        if (output->arrange_length == 0) {
+            continue;
         }
 
-        double columns_total_width = box.width - gap * (total_columns - 1);
+        struct wlr_box box;
+        output_get_usable_area(output, &box);
 
-        // Resize columns.
-        double column_x = box.x;
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            if (column->output != output) {
-                continue;
-            }
+        double columns_total_width = hwd_layout_arrange_columns(
+            box.x, box.width, gap, &layout_columns[output->arrange_start], output->arrange_length
+        );
+
+        for (size_t j = 0; j < output->arrange_length; j++) {
+            struct hwd_column *column = grouped_columns[output->arrange_start + j];
+            struct hwd_layout_column *layout_column = &layout_columns[output->arrange_start + j];
 
+            column->width_fraction = layout_column->width_fraction;
             column->child_total_width = columns_total_width;
-            column->pending.x = column_x;
+            column->pending.x = layout_column->x;
             column->pending.y = box.y;
-            column->pending.width = round(column->width_fraction * columns_total_width);
+            column->pending.width = layout_column->width;
             column->pending.height = box.height;
-            column_x += column->pending.width + gap;
-
-            // Make last child use remaining width of parent.
-            if (j == total_columns - 1) {
-                column->pending.width = box.x + box.width - column->pending.x;
-            }
+            column->pending.is_first_child = j == 0;
+            column->pending.is_last_child = j == output->arrange_length - 1;
         }
     }
 
@@ -621,7 +643,7 @@ workspace_add_floating(struct hwd_workspace *workspace, struct hwd_window *windo
     if (window->output_history->length == 0) {
         struct hwd_output *output = root_get_active_output(workspace->root);
         list_add(window->output_history, output);
-        window->output = output;
+        window_set_output(window, output);
     }
 
     window_reconcile_floating(window, workspace);
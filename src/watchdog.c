@@ -0,0 +1,195 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/watchdog.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <wayland-server-core.h>
+
+#include <wlr/util/log.h>
+
+#include <hayward/profiler.h>
+
+struct hwd_watchdog {
+    int period_ms;
+    hwd_timestamp timeout;
+
+    struct wl_event_source *heartbeat_timer;
+
+    // Time at which the main loop is next expected to service the heartbeat
+    // timer.  The loop is considered stalled once it is more than `timeout`
+    // late.
+    _Atomic hwd_timestamp heartbeat_due;
+
+    // Deadline of the most recently reported stall, so that each stall is
+    // only reported once.
+    hwd_timestamp reported_due;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool stopping;
+};
+
+static double
+timestamp_to_msec(hwd_timestamp timestamp) {
+    return (double)timestamp / 1000000.0;
+}
+
+static int
+handle_heartbeat(void *data) {
+    struct hwd_watchdog *watchdog = data;
+
+    hwd_timestamp now = hwd_profiler_now();
+    hwd_timestamp due = atomic_load(&watchdog->heartbeat_due);
+
+    if (now >= due + watchdog->timeout) {
+        wlr_log(
+            WLR_ERROR, "Watchdog: main loop recovered %.1fms after its heartbeat was due",
+            timestamp_to_msec(now - due)
+        );
+    }
+
+    atomic_store(&watchdog->heartbeat_due, now + (hwd_timestamp)watchdog->period_ms * 1000000);
+    wl_event_source_timer_update(watchdog->heartbeat_timer, watchdog->period_ms);
+
+    return 0;
+}
+
+static void
+watchdog_report(hwd_timestamp now, hwd_timestamp due) {
+    // The main thread keeps running while we read the stack, so the snapshot
+    // may be slightly torn.  Span names are string literals and so remain
+    // valid regardless.
+    size_t depth = atomic_load_explicit(&hwd_profiler_stack.depth, memory_order_acquire);
+
+    wlr_log(
+        WLR_ERROR, "Watchdog: main loop heartbeat is %.1fms overdue (%zu open spans)",
+        timestamp_to_msec(now - due), depth
+    );
+
+    if (depth > HWD_PROFILER_STACK_SIZE) {
+        depth = HWD_PROFILER_STACK_SIZE;
+    }
+    for (size_t i = 0; i < depth; i++) {
+        const char *message = atomic_load_explicit(
+            &hwd_profiler_stack.spans[i].message, memory_order_relaxed
+        );
+        hwd_timestamp begin =
+            atomic_load_explicit(&hwd_profiler_stack.spans[i].begin, memory_order_relaxed);
+
+        wlr_log(
+            WLR_ERROR, "Watchdog:   #%zu %s (running for %.1fms)", i,
+            message != NULL ? message : "?", timestamp_to_msec(now - begin)
+        );
+    }
+}
+
+static void *
+watchdog_thread(void *data) {
+    struct hwd_watchdog *watchdog = data;
+
+    pthread_mutex_lock(&watchdog->lock);
+    while (!watchdog->stopping) {
+        hwd_timestamp now = hwd_profiler_now();
+        hwd_timestamp due = atomic_load(&watchdog->heartbeat_due);
+
+        // Sleep until the heartbeat becomes overdue by the timeout.  If it
+        // has already been reported then there is nothing to do until the
+        // loop recovers, so check back after another timeout.
+        hwd_timestamp deadline = due + watchdog->timeout;
+        if (now >= deadline && due != watchdog->reported_due) {
+            watchdog->reported_due = due;
+            watchdog_report(now, due);
+        }
+        if (now >= deadline) {
+            deadline = now + watchdog->timeout;
+        }
+
+        struct timespec wake = {
+            .tv_sec = (time_t)(deadline / 1000000000),
+            .tv_nsec = (long)(deadline % 1000000000),
+        };
+        pthread_cond_timedwait(&watchdog->cond, &watchdog->lock, &wake);
+    }
+    pthread_mutex_unlock(&watchdog->lock);
+
+    return NULL;
+}
+
+struct hwd_watchdog *
+hwd_watchdog_create(struct wl_event_loop *event_loop, int timeout_ms) {
+    assert(timeout_ms > 0);
+
+    struct hwd_watchdog *watchdog = calloc(1, sizeof(struct hwd_watchdog));
+    if (watchdog == NULL) {
+        wlr_log(WLR_ERROR, "Unable to allocate watchdog");
+        return NULL;
+    }
+
+    watchdog->period_ms = timeout_ms / 2 > 0 ? timeout_ms / 2 : 1;
+    watchdog->timeout = (hwd_timestamp)timeout_ms * 1000000;
+    atomic_init(
+        &watchdog->heartbeat_due,
+        hwd_profiler_now() + (hwd_timestamp)watchdog->period_ms * 1000000
+    );
+
+    watchdog->heartbeat_timer = wl_event_loop_add_timer(event_loop, handle_heartbeat, watchdog);
+    if (watchdog->heartbeat_timer == NULL) {
+        wlr_log_errno(WLR_ERROR, "Unable to create watchdog heartbeat timer");
+        free(watchdog);
+        return NULL;
+    }
+    wl_event_source_timer_update(watchdog->heartbeat_timer, watchdog->period_ms);
+
+    pthread_condattr_t condattr;
+    pthread_condattr_init(&condattr);
+    pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&watchdog->cond, &condattr);
+    pthread_condattr_destroy(&condattr);
+    pthread_mutex_init(&watchdog->lock, NULL);
+
+    if (pthread_create(&watchdog->thread, NULL, watchdog_thread, watchdog) != 0) {
+        wlr_log(WLR_ERROR, "Unable to start watchdog thread");
+        pthread_mutex_destroy(&watchdog->lock);
+        pthread_cond_destroy(&watchdog->cond);
+        wl_event_source_remove(watchdog->heartbeat_timer);
+        free(watchdog);
+        return NULL;
+    }
+
+    hwd_profiler_stack_enabled = true;
+
+    wlr_log(WLR_INFO, "Watchdog started with a %dms timeout", timeout_ms);
+
+    return watchdog;
+}
+
+void
+hwd_watchdog_destroy(struct hwd_watchdog *watchdog) {
+    if (watchdog == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&watchdog->lock);
+    watchdog->stopping = true;
+    pthread_cond_signal(&watchdog->cond);
+    pthread_mutex_unlock(&watchdog->lock);
+
+    pthread_join(watchdog->thread, NULL);
+
+    hwd_profiler_stack_enabled = false;
+
+    pthread_mutex_destroy(&watchdog->lock);
+    pthread_cond_destroy(&watchdog->cond);
+    wl_event_source_remove(watchdog->heartbeat_timer);
+    free(watchdog);
+}
@@ -0,0 +1,50 @@
+/*
+ * Counts heap allocations made by the compositor.  Loaded with `LD_PRELOAD` by
+ * the benchmark harness, and read by the compositor through
+ * `hwd_bench_allocation_count` when `-D txn-stats` is enabled.
+ *
+ * Forwards to the glibc allocator directly to avoid having to bootstrap
+ * through `dlsym`.  Aligned allocations are not counted.
+ */
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+extern void *
+__libc_malloc(size_t size);
+
+extern void *
+__libc_calloc(size_t nmemb, size_t size);
+
+extern void *
+__libc_realloc(void *ptr, size_t size);
+
+static atomic_size_t allocations;
+
+size_t
+hwd_bench_allocation_count(void);
+
+size_t
+hwd_bench_allocation_count(void) {
+    return atomic_load_explicit(&allocations, memory_order_relaxed);
+}
+
+void *
+malloc(size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
@@ -0,0 +1,640 @@
+/*
+ * Synthetic xdg-shell client used by the benchmark harness.
+ *
+ * Maps a configurable number of toplevels, each with a configurable number of
+ * subsurfaces, and then repeatedly runs a script of operations against them.
+ * Configures are acknowledged after an artificial delay to simulate slow
+ * clients.  Every operation is timed from the first request until the
+ * compositor stops sending configures, and reported on stdout as:
+ *
+ *     op <name> <nanoseconds>
+ *
+ * With `-R` the client is instead driven by the compositor when replaying a
+ * recording, and reads one instruction per line from stdin:
+ *
+ *     map <id>            Map a new window and reply once it has settled.
+ *     unmap <id>          Unmap a window and reply once it has settled.
+ *     ack <id> <usec>     Set the delay before the window acknowledges
+ *                         configures.
+ *
+ * Replies are a single `ok` line on stdout.
+ */
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <wayland-client.h>
+
+#include "xdg-shell-client-protocol.h"
+
+#define DEFAULT_WIDTH 640
+#define DEFAULT_HEIGHT 480
+#define SUBSURFACE_SIZE 32
+
+struct bench_client;
+
+struct bench_window {
+    struct bench_client *client;
+    uint64_t id;
+
+    struct wl_surface *surface;
+    struct xdg_surface *xdg_surface;
+    struct xdg_toplevel *xdg_toplevel;
+
+    int num_subsurfaces;
+    struct wl_surface **subsurface_surfaces;
+    struct wl_subsurface **subsurfaces;
+
+    int32_t pending_width;
+    int32_t pending_height;
+    bool pending_fullscreen;
+
+    uint64_t ack_delay_nsec;
+    bool configure_pending;
+    uint32_t configure_serial;
+    uint64_t configure_time;
+
+    bool fullscreen;
+};
+
+struct bench_client {
+    struct wl_display *display;
+    struct wl_registry *registry;
+    struct wl_compositor *compositor;
+    struct wl_subcompositor *subcompositor;
+    struct wl_shm *shm;
+    struct xdg_wm_base *wm_base;
+
+    int num_windows;
+    int windows_capacity;
+    struct bench_window **windows;
+
+    int num_subsurfaces;
+    int ack_delay_ms;
+
+    size_t num_configures;
+    unsigned int num_buffers;
+};
+
+static uint64_t
+now_nsec(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+static void
+handle_buffer_release(void *data, struct wl_buffer *wl_buffer) {
+    wl_buffer_destroy(wl_buffer);
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+    .release = handle_buffer_release,
+};
+
+static struct wl_buffer *
+create_buffer(struct bench_client *client, int32_t width, int32_t height) {
+    int32_t stride = width * 4;
+    size_t size = (size_t)stride * (size_t)height;
+
+    char name[64];
+    snprintf(name, sizeof(name), "/hwd-bench-%d-%u", (int)getpid(), client->num_buffers++);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "shm_open failed: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    shm_unlink(name);
+
+    if (ftruncate(fd, (off_t)size) < 0) {
+        fprintf(stderr, "ftruncate failed: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    void *pixels = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (pixels == MAP_FAILED) {
+        fprintf(stderr, "mmap failed: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    memset(pixels, 0xff, size);
+    munmap(pixels, size);
+
+    struct wl_shm_pool *pool = wl_shm_create_pool(client->shm, fd, (int32_t)size);
+    struct wl_buffer *buffer =
+        wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    wl_buffer_add_listener(buffer, &buffer_listener, NULL);
+
+    return buffer;
+}
+
+static void
+window_ack_configure(struct bench_window *window) {
+    struct bench_client *client = window->client;
+
+    int32_t width = window->pending_width > 0 ? window->pending_width : DEFAULT_WIDTH;
+    int32_t height = window->pending_height > 0 ? window->pending_height : DEFAULT_HEIGHT;
+
+    xdg_surface_ack_configure(window->xdg_surface, window->configure_serial);
+    window->configure_pending = false;
+    window->fullscreen = window->pending_fullscreen;
+
+    wl_surface_attach(window->surface, create_buffer(client, width, height), 0, 0);
+    wl_surface_damage_buffer(window->surface, 0, 0, width, height);
+    wl_surface_commit(window->surface);
+}
+
+static void
+handle_xdg_surface_configure(void *data, struct xdg_surface *xdg_surface, uint32_t serial) {
+    struct bench_window *window = data;
+
+    window->configure_pending = true;
+    window->configure_serial = serial;
+    window->configure_time = now_nsec();
+    window->client->num_configures++;
+
+    if (window->ack_delay_nsec == 0) {
+        window_ack_configure(window);
+    }
+}
+
+static const struct xdg_surface_listener xdg_surface_listener = {
+    .configure = handle_xdg_surface_configure,
+};
+
+static void
+handle_xdg_toplevel_configure(
+    void *data, struct xdg_toplevel *xdg_toplevel, int32_t width, int32_t height,
+    struct wl_array *states
+) {
+    struct bench_window *window = data;
+
+    window->pending_width = width;
+    window->pending_height = height;
+    window->pending_fullscreen = false;
+
+    uint32_t *state;
+    wl_array_for_each(state, states) {
+        if (*state == XDG_TOPLEVEL_STATE_FULLSCREEN) {
+            window->pending_fullscreen = true;
+        }
+    }
+}
+
+static void
+handle_xdg_toplevel_close(void *data, struct xdg_toplevel *xdg_toplevel) {}
+
+static void
+handle_xdg_toplevel_configure_bounds(
+    void *data, struct xdg_toplevel *xdg_toplevel, int32_t width, int32_t height
+) {}
+
+static const struct xdg_toplevel_listener xdg_toplevel_listener = {
+    .configure = handle_xdg_toplevel_configure,
+    .close = handle_xdg_toplevel_close,
+    .configure_bounds = handle_xdg_toplevel_configure_bounds,
+};
+
+static struct bench_window *
+window_create(struct bench_client *client, uint64_t id) {
+    struct bench_window *window = calloc(1, sizeof(struct bench_window));
+    if (window == NULL) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    window->client = client;
+    window->id = id;
+    window->ack_delay_nsec = (uint64_t)client->ack_delay_ms * 1000000;
+
+    window->surface = wl_compositor_create_surface(client->compositor);
+    window->xdg_surface = xdg_wm_base_get_xdg_surface(client->wm_base, window->surface);
+    xdg_surface_add_listener(window->xdg_surface, &xdg_surface_listener, window);
+    window->xdg_toplevel = xdg_surface_get_toplevel(window->xdg_surface);
+    xdg_toplevel_add_listener(window->xdg_toplevel, &xdg_toplevel_listener, window);
+
+    char title[32];
+    snprintf(title, sizeof(title), "bench-%llu", (unsigned long long)id);
+    xdg_toplevel_set_title(window->xdg_toplevel, title);
+    xdg_toplevel_set_app_id(window->xdg_toplevel, "hayward-bench");
+
+    window->num_subsurfaces = client->num_subsurfaces;
+    window->subsurface_surfaces = calloc(window->num_subsurfaces, sizeof(struct wl_surface *));
+    window->subsurfaces = calloc(window->num_subsurfaces, sizeof(struct wl_subsurface *));
+    for (int i = 0; i < window->num_subsurfaces; i++) {
+        struct wl_surface *surface = wl_compositor_create_surface(client->compositor);
+        struct wl_subsurface *subsurface =
+            wl_subcompositor_get_subsurface(client->subcompositor, surface, window->surface);
+        wl_subsurface_set_position(subsurface, i * 8, i * 8);
+
+        wl_surface_attach(
+            surface, create_buffer(client, SUBSURFACE_SIZE, SUBSURFACE_SIZE), 0, 0
+        );
+        wl_surface_damage_buffer(surface, 0, 0, SUBSURFACE_SIZE, SUBSURFACE_SIZE);
+        wl_surface_commit(surface);
+
+        window->subsurface_surfaces[i] = surface;
+        window->subsurfaces[i] = subsurface;
+    }
+
+    // Initial commit without a buffer.  The compositor replies with a
+    // configure, and the window is mapped once that is acknowledged.
+    wl_surface_commit(window->surface);
+
+    return window;
+}
+
+static void
+window_destroy(struct bench_window *window) {
+    for (int i = 0; i < window->num_subsurfaces; i++) {
+        wl_subsurface_destroy(window->subsurfaces[i]);
+        wl_surface_destroy(window->subsurface_surfaces[i]);
+    }
+    free(window->subsurfaces);
+    free(window->subsurface_surfaces);
+
+    xdg_toplevel_destroy(window->xdg_toplevel);
+    xdg_surface_destroy(window->xdg_surface);
+    wl_surface_destroy(window->surface);
+
+    free(window);
+}
+
+static void
+handle_wm_base_ping(void *data, struct xdg_wm_base *wm_base, uint32_t serial) {
+    xdg_wm_base_pong(wm_base, serial);
+}
+
+static const struct xdg_wm_base_listener wm_base_listener = {
+    .ping = handle_wm_base_ping,
+};
+
+static void
+handle_registry_global(
+    void *data, struct wl_registry *registry, uint32_t name, const char *interface,
+    uint32_t version
+) {
+    struct bench_client *client = data;
+
+    if (strcmp(interface, wl_compositor_interface.name) == 0) {
+        client->compositor = wl_registry_bind(registry, name, &wl_compositor_interface, 4);
+    } else if (strcmp(interface, wl_subcompositor_interface.name) == 0) {
+        client->subcompositor = wl_registry_bind(registry, name, &wl_subcompositor_interface, 1);
+    } else if (strcmp(interface, wl_shm_interface.name) == 0) {
+        client->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
+    } else if (strcmp(interface, xdg_wm_base_interface.name) == 0) {
+        client->wm_base = wl_registry_bind(registry, name, &xdg_wm_base_interface, 4);
+        xdg_wm_base_add_listener(client->wm_base, &wm_base_listener, client);
+    }
+}
+
+static void
+handle_registry_global_remove(void *data, struct wl_registry *registry, uint32_t name) {}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = handle_registry_global,
+    .global_remove = handle_registry_global_remove,
+};
+
+/**
+ * Acknowledges every configure whose delay has elapsed, and returns the number
+ * of milliseconds until the next one is due, or -1 if none are pending.
+ */
+static int
+client_ack_due(struct bench_client *client) {
+    uint64_t now = now_nsec();
+    int timeout = -1;
+
+    for (int i = 0; i < client->num_windows; i++) {
+        struct bench_window *window = client->windows[i];
+        if (!window->configure_pending) {
+            continue;
+        }
+
+        uint64_t due = window->configure_time + window->ack_delay_nsec;
+        if (due <= now) {
+            window_ack_configure(window);
+            continue;
+        }
+
+        int remaining = (int)((due - now + 999999) / 1000000);
+        if (timeout < 0 || remaining < timeout) {
+            timeout = remaining;
+        }
+    }
+
+    return timeout;
+}
+
+static void
+client_dispatch_timeout(struct bench_client *client, int timeout_ms) {
+    while (wl_display_prepare_read(client->display) != 0) {
+        wl_display_dispatch_pending(client->display);
+    }
+    wl_display_flush(client->display);
+
+    struct pollfd pfd = {.fd = wl_display_get_fd(client->display), .events = POLLIN};
+    if (poll(&pfd, 1, timeout_ms) > 0) {
+        wl_display_read_events(client->display);
+    } else {
+        wl_display_cancel_read(client->display);
+    }
+
+    if (wl_display_dispatch_pending(client->display) < 0) {
+        fprintf(stderr, "Lost connection to compositor\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Waits until every configure has been acknowledged and the compositor has
+ * stopped sending new ones.  Configures are sent from an idle callback after
+ * the requests that trigger them, so a single roundtrip is not enough to be
+ * sure that nothing else is on its way.
+ */
+static void
+client_settle(struct bench_client *client) {
+    int quiet_roundtrips = 0;
+
+    while (quiet_roundtrips < 2) {
+        int timeout = client_ack_due(client);
+        if (timeout >= 0) {
+            client_dispatch_timeout(client, timeout);
+            quiet_roundtrips = 0;
+            continue;
+        }
+
+        size_t num_configures = client->num_configures;
+        if (wl_display_roundtrip(client->display) < 0) {
+            fprintf(stderr, "Lost connection to compositor\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if (client->num_configures == num_configures) {
+            quiet_roundtrips++;
+        } else {
+            quiet_roundtrips = 0;
+        }
+    }
+}
+
+static void
+report(const char *name, uint64_t begin) {
+    printf("op %s %llu\n", name, (unsigned long long)(now_nsec() - begin));
+    fflush(stdout);
+}
+
+static void
+run_op(struct bench_client *client, const char *op, int iteration) {
+    struct bench_window **window = &client->windows[iteration % client->num_windows];
+    uint64_t begin = now_nsec();
+
+    if (strcmp(op, "fullscreen") == 0) {
+        if ((*window)->fullscreen) {
+            xdg_toplevel_unset_fullscreen((*window)->xdg_toplevel);
+        } else {
+            xdg_toplevel_set_fullscreen((*window)->xdg_toplevel, NULL);
+        }
+    } else if (strcmp(op, "remap") == 0) {
+        uint64_t id = (*window)->id;
+        window_destroy(*window);
+        *window = window_create(client, id);
+    } else {
+        fprintf(stderr, "Unknown operation: %s\n", op);
+        exit(EXIT_FAILURE);
+    }
+
+    client_settle(client);
+    report(op, begin);
+}
+
+static struct bench_window **
+client_find_window(struct bench_client *client, uint64_t id) {
+    for (int i = 0; i < client->num_windows; i++) {
+        if (client->windows[i]->id == id) {
+            return &client->windows[i];
+        }
+    }
+    return NULL;
+}
+
+static void
+run_instruction(struct bench_client *client, char *line) {
+    char *saveptr = NULL;
+    char *instruction = strtok_r(line, " ", &saveptr);
+    char *id_str = strtok_r(NULL, " ", &saveptr);
+    if (instruction == NULL || id_str == NULL) {
+        fprintf(stderr, "Malformed instruction\n");
+        return;
+    }
+    uint64_t id = strtoull(id_str, NULL, 10);
+
+    if (strcmp(instruction, "map") == 0) {
+        if (client->num_windows == client->windows_capacity) {
+            client->windows_capacity = client->windows_capacity ? client->windows_capacity * 2 : 16;
+            client->windows =
+                realloc(client->windows, client->windows_capacity * sizeof(struct bench_window *));
+            if (client->windows == NULL) {
+                fprintf(stderr, "Allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        client->windows[client->num_windows++] = window_create(client, id);
+        client_settle(client);
+        printf("ok\n");
+    } else if (strcmp(instruction, "unmap") == 0) {
+        struct bench_window **window = client_find_window(client, id);
+        if (window != NULL) {
+            window_destroy(*window);
+            *window = client->windows[--client->num_windows];
+        }
+        client_settle(client);
+        printf("ok\n");
+    } else if (strcmp(instruction, "ack") == 0) {
+        char *delay_str = strtok_r(NULL, " ", &saveptr);
+        struct bench_window **window = client_find_window(client, id);
+        if (window != NULL && delay_str != NULL) {
+            (*window)->ack_delay_nsec = strtoull(delay_str, NULL, 10) * 1000;
+        }
+    } else {
+        fprintf(stderr, "Unknown instruction: %s\n", instruction);
+    }
+    fflush(stdout);
+}
+
+/**
+ * Runs instructions from stdin until it is closed, acknowledging configures
+ * while waiting for the next one.
+ */
+static void
+run_driven(struct bench_client *client) {
+    char buffer[1024];
+    size_t length = 0;
+
+    while (true) {
+        int timeout = client_ack_due(client);
+
+        while (wl_display_prepare_read(client->display) != 0) {
+            wl_display_dispatch_pending(client->display);
+        }
+        wl_display_flush(client->display);
+
+        struct pollfd pfds[2] = {
+            {.fd = wl_display_get_fd(client->display), .events = POLLIN},
+            {.fd = STDIN_FILENO, .events = POLLIN},
+        };
+        if (poll(pfds, 2, timeout) < 0) {
+            wl_display_cancel_read(client->display);
+            continue;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            wl_display_read_events(client->display);
+        } else {
+            wl_display_cancel_read(client->display);
+        }
+        if (wl_display_dispatch_pending(client->display) < 0) {
+            fprintf(stderr, "Lost connection to compositor\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if (pfds[1].revents & (POLLIN | POLLHUP)) {
+            ssize_t n = read(STDIN_FILENO, &buffer[length], sizeof(buffer) - length - 1);
+            if (n <= 0) {
+                return;
+            }
+            length += n;
+
+            char *begin = buffer;
+            char *end;
+            while ((end = memchr(begin, '\n', &buffer[length] - begin)) != NULL) {
+                *end = '\0';
+                run_instruction(client, begin);
+                begin = end + 1;
+            }
+            length -= begin - buffer;
+            memmove(buffer, begin, length);
+        }
+    }
+}
+
+static const char usage[] = "Usage: hayward-bench-client [options]\n"
+                            "\n"
+                            "  -w <count>   Number of windows to map (default 8).\n"
+                            "  -s <count>   Number of subsurfaces per window (default 0).\n"
+                            "  -a <msec>    Delay before acknowledging configures (default 0).\n"
+                            "  -n <count>   Number of iterations of the script (default 100).\n"
+                            "  -o <ops>     Comma separated operations to run each iteration.\n"
+                            "               One or more of `fullscreen` and `remap`.\n"
+                            "  -R           Read instructions from stdin to replay a recording.\n";
+
+int
+main(int argc, char **argv) {
+    struct bench_client client = {.num_windows = 8};
+    int iterations = 100;
+    const char *script = "fullscreen,remap";
+    bool driven = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "w:s:a:n:o:Rh")) != -1) {
+        switch (c) {
+        case 'w':
+            client.num_windows = atoi(optarg);
+            break;
+        case 's':
+            client.num_subsurfaces = atoi(optarg);
+            break;
+        case 'a':
+            client.ack_delay_ms = atoi(optarg);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'o':
+            script = optarg;
+            break;
+        case 'R':
+            driven = true;
+            break;
+        default:
+            fprintf(stderr, "%s", usage);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (driven) {
+        client.num_windows = 0;
+    } else if (client.num_windows < 1) {
+        fprintf(stderr, "At least one window is required\n");
+        return EXIT_FAILURE;
+    }
+
+    client.display = wl_display_connect(NULL);
+    if (client.display == NULL) {
+        fprintf(stderr, "Failed to connect to compositor\n");
+        return EXIT_FAILURE;
+    }
+
+    client.registry = wl_display_get_registry(client.display);
+    wl_registry_add_listener(client.registry, &registry_listener, &client);
+    wl_display_roundtrip(client.display);
+
+    if (client.compositor == NULL || client.subcompositor == NULL || client.shm == NULL ||
+        client.wm_base == NULL) {
+        fprintf(stderr, "Compositor is missing required globals\n");
+        return EXIT_FAILURE;
+    }
+
+    if (driven) {
+        run_driven(&client);
+    } else {
+        uint64_t begin = now_nsec();
+        client.windows = calloc(client.num_windows, sizeof(struct bench_window *));
+        for (int i = 0; i < client.num_windows; i++) {
+            client.windows[i] = window_create(&client, i);
+        }
+        client_settle(&client);
+        report("setup", begin);
+
+        for (int i = 0; i < iterations; i++) {
+            char *saveptr = NULL;
+            char *scratch = strdup(script);
+            for (char *op = strtok_r(scratch, ",", &saveptr); op != NULL;
+                 op = strtok_r(NULL, ",", &saveptr)) {
+                run_op(&client, op, i);
+            }
+            free(scratch);
+        }
+    }
+
+    for (int i = 0; i < client.num_windows; i++) {
+        window_destroy(client.windows[i]);
+    }
+    free(client.windows);
+
+    xdg_wm_base_destroy(client.wm_base);
+    wl_shm_destroy(client.shm);
+    wl_subcompositor_destroy(client.subcompositor);
+    wl_compositor_destroy(client.compositor);
+    wl_registry_destroy(client.registry);
+    wl_display_roundtrip(client.display);
+    wl_display_disconnect(client.display);
+
+    printf("done\n");
+    fflush(stdout);
+
+    return EXIT_SUCCESS;
+}
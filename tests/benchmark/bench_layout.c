@@ -0,0 +1,381 @@
+/*
+ * Standalone benchmark for the tiling layout math.
+ *
+ * Builds a synthetic tree of columns and windows spread across a number of
+ * outputs, and repeatedly arranges it using the same functions as the
+ * compositor.  Reports the mean time taken to arrange the whole tree, and the
+ * time per column and per window, on stdout as:
+ *
+ *     arrange <name> <nanoseconds>
+ *
+ * With `-t` the benchmark instead runs a single pass over a range of tree
+ * shapes and checks that the results are consistent: columns exactly fill
+ * their output, windows are contiguous, and only the active window in a
+ * stacked column is left unshaded.  Exits with a non-zero status on failure.
+ */
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hayward/tree/layout.h>
+
+#define OUTPUT_WIDTH 2560
+#define OUTPUT_HEIGHT 1440
+#define GAP 8
+#define TITLEBAR_HEIGHT 30
+
+struct bench_column {
+    struct hwd_layout_column layout;
+    bool stacked;
+    size_t active;
+    size_t num_windows;
+    struct hwd_layout_window *windows;
+};
+
+struct bench_output {
+    double x;
+    double width;
+    double height;
+    size_t num_columns;
+    struct bench_column *columns;
+};
+
+struct bench_tree {
+    size_t num_outputs;
+    struct bench_output *outputs;
+};
+
+static void *
+xcalloc(size_t count, size_t size) {
+    void *ptr = calloc(count, size);
+    if (ptr == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static uint64_t
+now_nsec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static void
+tree_init(
+    struct bench_tree *tree, size_t num_outputs, size_t num_columns, size_t num_windows,
+    bool stacked
+) {
+    tree->num_outputs = num_outputs;
+    tree->outputs = xcalloc(num_outputs, sizeof(struct bench_output));
+
+    for (size_t i = 0; i < num_outputs; i++) {
+        struct bench_output *output = &tree->outputs[i];
+        output->x = (double)i * OUTPUT_WIDTH;
+        output->width = OUTPUT_WIDTH;
+        output->height = OUTPUT_HEIGHT;
+
+        // Distribute columns round-robin so that outputs differ by at most one.
+        output->num_columns = num_columns / num_outputs + (i < num_columns % num_outputs);
+        output->columns = xcalloc(output->num_columns, sizeof(struct bench_column));
+
+        for (size_t j = 0; j < output->num_columns; j++) {
+            struct bench_column *column = &output->columns[j];
+
+            // Leave every third column new so that the fractions are
+            // redistributed on the first pass.
+            column->layout.width_fraction = j % 3 == 0 ? 0.0 : 1.0 + (double)(j % 5);
+            column->stacked = stacked;
+            column->active = j % (num_windows ? num_windows : 1);
+            column->num_windows = num_windows;
+            column->windows =
+                xcalloc(num_windows ? num_windows : 1, sizeof(struct hwd_layout_window));
+
+            for (size_t k = 0; k < num_windows; k++) {
+                struct hwd_layout_window *window = &column->windows[k];
+                window->height_fraction = 1.0 / (1.0 + (double)(k % 4));
+                window->titlebar_height = TITLEBAR_HEIGHT;
+                window->fullscreen = k % 17 == 16;
+            }
+        }
+    }
+}
+
+static void
+tree_finish(struct bench_tree *tree) {
+    for (size_t i = 0; i < tree->num_outputs; i++) {
+        struct bench_output *output = &tree->outputs[i];
+        for (size_t j = 0; j < output->num_columns; j++) {
+            free(output->columns[j].windows);
+        }
+        free(output->columns);
+    }
+    free(tree->outputs);
+}
+
+static void
+tree_arrange(struct bench_tree *tree, size_t *num_columns, size_t *num_windows) {
+    struct hwd_layout_preview preview = {0};
+
+    for (size_t i = 0; i < tree->num_outputs; i++) {
+        struct bench_output *output = &tree->outputs[i];
+
+        // The compositor copies columns into a scratch array, so do the same
+        // here to keep the measurement honest.
+        struct hwd_layout_column *layout_columns = xcalloc(
+            output->num_columns ? output->num_columns : 1, sizeof(struct hwd_layout_column)
+        );
+        for (size_t j = 0; j < output->num_columns; j++) {
+            layout_columns[j] = output->columns[j].layout;
+        }
+        hwd_layout_arrange_columns(
+            output->x, output->width, GAP, layout_columns, output->num_columns
+        );
+        for (size_t j = 0; j < output->num_columns; j++) {
+            output->columns[j].layout = layout_columns[j];
+        }
+        free(layout_columns);
+
+        for (size_t j = 0; j < output->num_columns; j++) {
+            struct bench_column *column = &output->columns[j];
+            if (column->stacked) {
+                hwd_layout_arrange_stacked(
+                    0, output->height, column->windows, column->num_windows, column->active,
+                    &preview
+                );
+            } else {
+                hwd_layout_arrange_split(
+                    0, output->height, column->windows, column->num_windows, &preview
+                );
+            }
+            *num_windows += column->num_windows;
+        }
+        *num_columns += output->num_columns;
+    }
+}
+
+static bool
+tree_check(struct bench_tree *tree) {
+    bool ok = true;
+
+    for (size_t i = 0; i < tree->num_outputs; i++) {
+        struct bench_output *output = &tree->outputs[i];
+        if (output->num_columns == 0) {
+            continue;
+        }
+
+        double fraction = 0.0;
+        double x = output->x;
+        for (size_t j = 0; j < output->num_columns; j++) {
+            struct bench_column *column = &output->columns[j];
+            fraction += column->layout.width_fraction;
+
+            if (column->layout.x != x) {
+                fprintf(
+                    stderr, "output %zu column %zu: expected x=%f, got %f\n", i, j, x,
+                    column->layout.x
+                );
+                ok = false;
+            }
+            if (column->layout.width != round(column->layout.width) ||
+                column->layout.x != round(column->layout.x)) {
+                fprintf(stderr, "output %zu column %zu: geometry not integral\n", i, j);
+                ok = false;
+            }
+            x = column->layout.x + column->layout.width + GAP;
+
+            double y = 0;
+            for (size_t k = 0; k < column->num_windows; k++) {
+                struct hwd_layout_window *window = &column->windows[k];
+                if (window->fullscreen) {
+                    continue;
+                }
+                if (window->y != y) {
+                    fprintf(
+                        stderr, "output %zu column %zu window %zu: expected y=%f, got %f\n", i,
+                        j, k, y, window->y
+                    );
+                    ok = false;
+                }
+                if (window->height < window->titlebar_height) {
+                    fprintf(
+                        stderr, "output %zu column %zu window %zu: height %f too small\n", i, j,
+                        k, window->height
+                    );
+                    ok = false;
+                }
+                if (window->shaded != (column->stacked && k != column->active)) {
+                    fprintf(
+                        stderr, "output %zu column %zu window %zu: unexpected shading\n", i, j,
+                        k
+                    );
+                    ok = false;
+                }
+                y = window->y + window->height;
+            }
+        }
+
+        if (fabs(fraction - 1.0) > 1e-9) {
+            fprintf(stderr, "output %zu: width fractions sum to %f\n", i, fraction);
+            ok = false;
+        }
+        if (x - GAP != output->x + output->width) {
+            fprintf(
+                stderr, "output %zu: columns end at %f, expected %f\n", i, x - GAP,
+                output->x + output->width
+            );
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static bool
+run_checks(void) {
+    static const size_t outputs[] = {1, 2, 3, 7};
+    static const size_t columns[] = {1, 2, 3, 5, 64, 1000};
+    static const size_t windows[] = {0, 1, 2, 9, 40};
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); i++) {
+        for (size_t j = 0; j < sizeof(columns) / sizeof(columns[0]); j++) {
+            for (size_t k = 0; k < sizeof(windows) / sizeof(windows[0]); k++) {
+                for (int stacked = 0; stacked < 2; stacked++) {
+                    struct bench_tree tree;
+                    tree_init(&tree, outputs[i], columns[j], windows[k], stacked);
+
+                    size_t num_columns = 0;
+                    size_t num_windows = 0;
+                    tree_arrange(&tree, &num_columns, &num_windows);
+                    if (!tree_check(&tree)) {
+                        fprintf(
+                            stderr, "failed: outputs=%zu columns=%zu windows=%zu stacked=%d\n",
+                            outputs[i], columns[j], windows[k], stacked
+                        );
+                        ok = false;
+                    }
+
+                    // Arranging again should be a no-op.
+                    tree_arrange(&tree, &num_columns, &num_windows);
+                    if (!tree_check(&tree)) {
+                        fprintf(
+                            stderr,
+                            "failed on rearrange: outputs=%zu columns=%zu windows=%zu "
+                            "stacked=%d\n",
+                            outputs[i], columns[j], windows[k], stacked
+                        );
+                        ok = false;
+                    }
+
+                    tree_finish(&tree);
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+static void
+run_benchmark(
+    size_t num_outputs, size_t num_columns, size_t num_windows, bool stacked, int iterations
+) {
+    struct bench_tree tree;
+    tree_init(&tree, num_outputs, num_columns, num_windows, stacked);
+
+    // Warm up, and settle any new columns.
+    size_t total_columns = 0;
+    size_t total_windows = 0;
+    tree_arrange(&tree, &total_columns, &total_windows);
+
+    total_columns = 0;
+    total_windows = 0;
+    uint64_t start = now_nsec();
+    for (int i = 0; i < iterations; i++) {
+        tree_arrange(&tree, &total_columns, &total_windows);
+    }
+    uint64_t duration = now_nsec() - start;
+
+    printf(
+        "outputs=%zu columns=%zu windows=%zu stacked=%d iterations=%d\n", num_outputs,
+        num_columns, num_windows, stacked, iterations
+    );
+    printf("arrange tree %" PRIu64 "\n", duration / (uint64_t)iterations);
+    if (total_columns) {
+        printf("arrange column %" PRIu64 "\n", duration / total_columns);
+    }
+    if (total_windows) {
+        printf("arrange window %" PRIu64 "\n", duration / total_windows);
+    }
+
+    tree_finish(&tree);
+}
+
+static void
+usage(const char *argv0) {
+    fprintf(
+        stderr,
+        "usage: %s [-t] [-o outputs] [-c columns] [-w windows per column] [-s] "
+        "[-n iterations]\n",
+        argv0
+    );
+}
+
+int
+main(int argc, char **argv) {
+    size_t num_outputs = 4;
+    size_t num_columns = 1000;
+    size_t num_windows = 8;
+    bool stacked = false;
+    int iterations = 1000;
+    bool check = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "to:c:w:sn:h")) != -1) {
+        switch (opt) {
+        case 't':
+            check = true;
+            break;
+        case 'o':
+            num_outputs = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            num_columns = strtoul(optarg, NULL, 10);
+            break;
+        case 'w':
+            num_windows = strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            stacked = true;
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (check) {
+        return run_checks() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (num_outputs == 0 || iterations <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    run_benchmark(num_outputs, num_columns, num_windows, stacked, iterations);
+    return EXIT_SUCCESS;
+}
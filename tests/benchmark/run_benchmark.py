@@ -0,0 +1,255 @@
+"""
+Runs hayward on the headless backend with a synthetic client, and reports
+transaction latency, arrange time, frame time and allocations per operation.
+
+The compositor is started with `-D txn-stats`, which logs one line for every
+transaction and every rendered frame.  Allocations are counted by preloading
+the `alloc_counter` library.
+
+With `--replay`, a log written with `-D record=<path>` is replayed instead of
+running the client's scripted operations.  The client is then spawned by the
+compositor to provide the recorded windows.
+"""
+import argparse
+import os
+import re
+import signal
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+
+CONFIG = """\
+xwayland disable
+"""
+
+DISPLAY_PATTERN = re.compile(r"Running compositor on wayland display '([^']*)'")
+STATS_PATTERN = re.compile(r"(txn-stats|frame-stats): (.*)$")
+REPLAY_FINISHED_PATTERN = re.compile(r"Replay finished")
+
+
+def parse_fields(text):
+    fields = {}
+    for field in text.split():
+        key, _, value = field.partition("=")
+        fields[key] = value
+    return fields
+
+
+def summarise(name, values, scale=1.0, unit=""):
+    if not values:
+        return f"  {name:<24} (no samples)"
+    values = sorted(value / scale for value in values)
+    p50 = values[len(values) // 2]
+    p99 = values[min(len(values) - 1, (len(values) * 99) // 100)]
+    return (
+        f"  {name:<24} n={len(values):<6} mean={statistics.fmean(values):10.3f}{unit}"
+        f" p50={p50:10.3f}{unit} p99={p99:10.3f}{unit} max={values[-1]:10.3f}{unit}"
+    )
+
+
+def run_client(args, env, display):
+    client_env = dict(env)
+    client_env["WAYLAND_DISPLAY"] = display
+    try:
+        return subprocess.run(
+            [
+                args.client,
+                "-w",
+                str(args.windows),
+                "-s",
+                str(args.subsurfaces),
+                "-a",
+                str(args.ack_delay),
+                "-n",
+                str(args.iterations),
+                "-o",
+                args.ops,
+            ],
+            env=client_env,
+            stdout=subprocess.PIPE,
+            encoding="utf-8",
+            timeout=args.timeout,
+        )
+    except subprocess.TimeoutExpired:
+        print("Client timed out", file=sys.stderr)
+        return None
+
+
+def run(args):
+    with tempfile.TemporaryDirectory(prefix="hayward-bench-") as runtime_dir:
+        config_path = os.path.join(runtime_dir, "config")
+        with open(config_path, "w") as config_file:
+            config_file.write(CONFIG)
+
+        env = dict(os.environ)
+        env.pop("WAYLAND_DISPLAY", None)
+        env.pop("DISPLAY", None)
+        env.update(
+            {
+                "XDG_RUNTIME_DIR": runtime_dir,
+                "WLR_BACKENDS": "headless",
+                "WLR_RENDERER": "pixman",
+                "WLR_HEADLESS_OUTPUTS": str(args.outputs),
+                "WLR_LIBINPUT_NO_DEVICES": "1",
+            }
+        )
+
+        compositor_env = dict(env)
+        if args.alloc_counter:
+            compositor_env["LD_PRELOAD"] = args.alloc_counter
+
+        command = [args.hayward, "--verbose", "-c", config_path, "-D", "txn-stats"]
+        if args.replay:
+            command += [
+                "-D",
+                f"replay={os.path.abspath(args.replay)}",
+                "-D",
+                f"replay-client={args.client} -R",
+            ]
+            if args.replay_fast:
+                command += ["-D", "replay-fast"]
+
+        compositor = subprocess.Popen(
+            command,
+            env=compositor_env,
+            stdin=subprocess.DEVNULL,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.PIPE,
+            encoding="utf-8",
+        )
+
+        display = None
+        display_ready = threading.Event()
+        replay_finished = threading.Event()
+        recording = threading.Event()
+        transactions = []
+        frames = []
+
+        def read_log():
+            nonlocal display
+            for line in compositor.stderr:
+                match = DISPLAY_PATTERN.search(line)
+                if match:
+                    display = match.group(1)
+                    display_ready.set()
+                    continue
+
+                if REPLAY_FINISHED_PATTERN.search(line):
+                    replay_finished.set()
+                    continue
+
+                match = STATS_PATTERN.search(line)
+                if match and recording.is_set():
+                    fields = parse_fields(match.group(2))
+                    if match.group(1) == "txn-stats":
+                        transactions.append(fields)
+                    else:
+                        frames.append(fields)
+            display_ready.set()
+            replay_finished.set()
+
+        reader = threading.Thread(target=read_log, daemon=True)
+        reader.start()
+
+        if not display_ready.wait(timeout=30) or display is None:
+            compositor.kill()
+            print("Compositor failed to start", file=sys.stderr)
+            return False
+
+        recording.set()
+
+        client = None
+        if args.replay:
+            if not replay_finished.wait(timeout=args.timeout):
+                compositor.kill()
+                compositor.wait()
+                print("Replay timed out", file=sys.stderr)
+                return False
+        else:
+            client = run_client(args, env, display)
+            if client is None:
+                compositor.kill()
+                compositor.wait()
+                return False
+
+        recording.clear()
+        compositor.send_signal(signal.SIGTERM)
+        try:
+            compositor.wait(timeout=30)
+        except subprocess.TimeoutExpired:
+            compositor.kill()
+            compositor.wait()
+        reader.join()
+
+    ops = {}
+    if client is not None:
+        if client.returncode != 0:
+            print(f"Client exited with status {client.returncode}", file=sys.stderr)
+            return False
+
+        for line in client.stdout.splitlines():
+            parts = line.split()
+            if len(parts) == 3 and parts[0] == "op":
+                ops.setdefault(parts[1], []).append(int(parts[2]))
+
+    num_ops = sum(len(samples) for name, samples in ops.items() if name != "setup")
+
+    if args.replay:
+        print(f"replay={args.replay} fast={args.replay_fast}")
+    else:
+        print(
+            f"windows={args.windows} subsurfaces={args.subsurfaces}"
+            f" ack-delay={args.ack_delay}ms iterations={args.iterations} ops={args.ops}"
+        )
+        print("Operations:")
+        for name, samples in sorted(ops.items()):
+            print(summarise(name, samples, scale=1e6, unit="ms"))
+
+    print("Transactions:")
+    for key, name in [
+        ("total", "latency"),
+        ("before_commit", "arrange"),
+        ("commit", "commit"),
+        ("confirm", "waiting for clients"),
+        ("apply", "apply"),
+    ]:
+        print(summarise(name, [int(txn[key]) for txn in transactions], scale=1e6, unit="ms"))
+
+    print("Frames:")
+    print(summarise("render", [int(frame["duration"]) for frame in frames], scale=1e6, unit="ms"))
+
+    allocations = sum(int(txn["allocations"]) for txn in transactions)
+    print("Allocations:")
+    if not args.alloc_counter:
+        print("  (allocation counter not loaded)")
+    else:
+        print(f"  per transaction          {allocations / max(len(transactions), 1):.1f}")
+        if num_ops:
+            print(f"  per operation            {allocations / num_ops:.1f}")
+
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--hayward", required=True)
+    parser.add_argument("--client", required=True)
+    parser.add_argument("--alloc-counter")
+    parser.add_argument("--outputs", type=int, default=1)
+    parser.add_argument("--windows", type=int, default=8)
+    parser.add_argument("--subsurfaces", type=int, default=0)
+    parser.add_argument("--ack-delay", type=int, default=0)
+    parser.add_argument("--iterations", type=int, default=100)
+    parser.add_argument("--ops", default="fullscreen,remap")
+    parser.add_argument("--replay")
+    parser.add_argument("--replay-fast", action="store_true")
+    parser.add_argument("--timeout", type=int, default=600)
+    args = parser.parse_args()
+
+    return run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(0 if main() else 1)